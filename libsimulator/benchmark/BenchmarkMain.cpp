@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "benchmarkCollisionGeometry.hpp"
+#include "benchmarkLineSegmentBlock.hpp"
+#include "benchmarkNeighborhoodSearch.hpp"
+#include "benchmarkOperationalDecisionSystem.hpp"
 
 #include <benchmark/benchmark.h>
 
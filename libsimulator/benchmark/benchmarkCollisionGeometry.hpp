@@ -5,6 +5,11 @@
 
 #include <benchmark/benchmark.h>
 
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
 template <class... Args>
 void bmLineSegmentsInDistanceTo(benchmark::State& state, Args&&... args)
 {
@@ -29,6 +34,54 @@ void bmLineSegmentsInApproxDistanceTo(benchmark::State& state, Args&&... args)
     }
 }
 
+template <class... Args>
+void bmInsideGeometry(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+    const auto& bounds = geometry.Bounds();
+    constexpr int steps = 100;
+
+    for(auto _ : state) {
+        for(int i = 0; i < steps; ++i) {
+            for(int j = 0; j < steps; ++j) {
+                const Point p{
+                    bounds.xmin + (bounds.xmax - bounds.xmin) * i / steps,
+                    bounds.ymin + (bounds.ymax - bounds.ymin) * j / steps};
+                benchmark::DoNotOptimize(geometry.InsideGeometry(p));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * steps * steps);
+}
+
+/// Line of sight checks between points 2 m apart, as done for every agent and its neighbors.
+template <class... Args>
+void bmIntersectsAny(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+    const auto& bounds = geometry.Bounds();
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> x(bounds.xmin, bounds.xmax);
+    std::uniform_real_distribution<double> y(bounds.ymin, bounds.ymax);
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+    std::vector<LineSegment> queries{};
+    for(size_t index = 0; index < 1024; ++index) {
+        const Point p{x(gen), y(gen)};
+        const auto a = angle(gen);
+        queries.emplace_back(p, p + Point{2 * std::cos(a), 2 * std::sin(a)});
+    }
+
+    for(auto _ : state) {
+        for(const auto& query : queries) {
+            benchmark::DoNotOptimize(geometry.IntersectsAny(query));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
 BENCHMARK_CAPTURE(bmLineSegmentsInDistanceTo, large_street_network, buildLargeStreetNetwork());
 
 BENCHMARK_CAPTURE(bmLineSegmentsInDistanceTo, grosser_stern, buildGrosserStern());
@@ -39,3 +92,11 @@ BENCHMARK_CAPTURE(
     buildLargeStreetNetwork());
 
 BENCHMARK_CAPTURE(bmLineSegmentsInApproxDistanceTo, grosser_stern, buildGrosserStern());
+
+BENCHMARK_CAPTURE(bmInsideGeometry, large_street_network, buildLargeStreetNetwork());
+
+BENCHMARK_CAPTURE(bmInsideGeometry, grosser_stern, buildGrosserStern());
+
+BENCHMARK_CAPTURE(bmIntersectsAny, large_street_network, buildLargeStreetNetwork());
+
+BENCHMARK_CAPTURE(bmIntersectsAny, grosser_stern, buildGrosserStern());
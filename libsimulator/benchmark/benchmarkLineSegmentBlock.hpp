@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "Point.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+static std::vector<LineSegment> randomLineSegments(size_t count)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coordinate(-4., 4.);
+    std::vector<LineSegment> segments{};
+    segments.reserve(count);
+    for(size_t index = 0; index < count; ++index) {
+        segments.emplace_back(
+            Point(coordinate(gen), coordinate(gen)), Point(coordinate(gen), coordinate(gen)));
+    }
+    return segments;
+}
+
+/// Closest points computed one linesegment at a time.
+static void bmShortestPointPerSegment(benchmark::State& state)
+{
+    const auto segments = randomLineSegments(static_cast<size_t>(state.range(0)));
+    const Point p{0.3, -0.2};
+    std::vector<Point> closest(segments.size());
+
+    for(auto _ : state) {
+        for(size_t index = 0; index < segments.size(); ++index) {
+            closest[index] = segments[index].ShortestPoint(p);
+        }
+        benchmark::DoNotOptimize(closest.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Closest points computed for a whole block with the given instruction set.
+static void
+bmClosestPointsToBlock(benchmark::State& state, LineSegmentBlock::InstructionSet instructionSet)
+{
+    if(!LineSegmentBlock::IsSupported(instructionSet)) {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    const LineSegmentBlock block(randomLineSegments(static_cast<size_t>(state.range(0))));
+    const Point p{0.3, -0.2};
+    ClosestPoints closest{};
+
+    for(auto _ : state) {
+        block.ClosestPointsTo(p, closest, instructionSet);
+        benchmark::DoNotOptimize(closest.x.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmShortestPointPerSegment)->RangeMultiplier(4)->Range(4, 1024);
+
+BENCHMARK_CAPTURE(bmClosestPointsToBlock, scalar, LineSegmentBlock::InstructionSet::Scalar)
+    ->RangeMultiplier(4)
+    ->Range(4, 1024);
+
+BENCHMARK_CAPTURE(bmClosestPointsToBlock, sse2, LineSegmentBlock::InstructionSet::Sse2)
+    ->RangeMultiplier(4)
+    ->Range(4, 1024);
+
+BENCHMARK_CAPTURE(bmClosestPointsToBlock, avx2, LineSegmentBlock::InstructionSet::Avx2)
+    ->RangeMultiplier(4)
+    ->Range(4, 1024);
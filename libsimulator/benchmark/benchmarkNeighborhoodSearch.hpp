@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "GenericAgent.hpp"
+#include "NeighborhoodSearch.hpp"
+#include "Point.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <vector>
+
+struct BenchmarkAgent {
+    Point pos{};
+    Point velocity{};
+
+    const Point& position() const { return pos; }
+};
+
+/// Agents spread with a density of 1 agent per m^2 over a square area, walking at 1.3 m/s.
+struct NeighborhoodSearchScenario {
+    AABB bounds;
+    AgentContainer<BenchmarkAgent> agents{};
+    AgentContainer<BenchmarkAgent> next{};
+
+    explicit NeighborhoodSearchScenario(size_t agentCount)
+    {
+        const double side = std::sqrt(static_cast<double>(agentCount));
+        bounds = AABB{Point{0, 0}, Point{side, side}};
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<double> coordinate(0, side);
+        std::uniform_real_distribution<double> angle(0, 2 * std::numbers::pi);
+        for(size_t index = 0; index < agentCount; ++index) {
+            const auto phi = angle(gen);
+            agents.push_back(
+                {{coordinate(gen), coordinate(gen)}, Point{std::cos(phi), std::sin(phi)} * 1.3});
+        }
+        next = agents;
+    }
+
+    /// Mimics the operational step: computes the next generation and swaps it in.
+    void Step(double dT)
+    {
+        for(size_t index = 0; index < agents.size(); ++index) {
+            auto pos = agents[index].pos + agents[index].velocity * dT;
+            auto velocity = agents[index].velocity;
+            if(!bounds.Inside(pos)) {
+                velocity = velocity * -1.;
+                pos = agents[index].pos;
+            }
+            next[index] = {pos, velocity};
+        }
+        agents.swap(next);
+    }
+};
+
+/// Neighborhood maintenance of one iteration as done before incremental updates: the grid is
+/// rebuilt before the stage system and again after the operational step.
+static void bmNeighborhoodSearchFullRebuild(benchmark::State& state)
+{
+    NeighborhoodSearchScenario scenario(static_cast<size_t>(state.range(0)));
+    NeighborhoodSearch<BenchmarkAgent> neighborhoodSearch{2.2, scenario.bounds};
+    neighborhoodSearch.Update(scenario.agents);
+
+    for(auto _ : state) {
+        neighborhoodSearch.Update(scenario.agents);
+        state.PauseTiming();
+        scenario.Step(0.01);
+        state.ResumeTiming();
+        neighborhoodSearch.Update(scenario.agents);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Neighborhood maintenance of one iteration with incremental updates.
+static void bmNeighborhoodSearchIncremental(benchmark::State& state)
+{
+    NeighborhoodSearchScenario scenario(static_cast<size_t>(state.range(0)));
+    NeighborhoodSearch<BenchmarkAgent> neighborhoodSearch{2.2, scenario.bounds};
+    neighborhoodSearch.Update(scenario.agents);
+
+    for(auto _ : state) {
+        neighborhoodSearch.UpdatePositions(scenario.agents);
+        state.PauseTiming();
+        scenario.Step(0.01);
+        state.ResumeTiming();
+        neighborhoodSearch.UpdatePositions(scenario.agents);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmNeighborhoodSearchFullRebuild)
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(bmNeighborhoodSearchIncremental)
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Unit(benchmark::kMicrosecond);
+
+/// Neighbor queries of one operational step over agents with a full model state.
+static void bmNeighborhoodSearchQuery(benchmark::State& state)
+{
+    const NeighborhoodSearchScenario scenario(static_cast<size_t>(state.range(0)));
+    AgentContainer<GenericAgent> agents{};
+    for(const auto& agent : scenario.agents) {
+        agents.emplace_back(
+            GenericAgent::ID::Invalid,
+            jps::UniqueID<Journey>::Invalid,
+            jps::UniqueID<BaseStage>::Invalid,
+            CollisionFreeSpeedModel::State{agent.pos});
+    }
+    NeighborhoodSearch<GenericAgent> neighborhoodSearch{2.2, scenario.bounds};
+    neighborhoodSearch.Update(agents);
+
+    std::vector<const GenericAgent*> neighbors{};
+    for(auto _ : state) {
+        size_t found = 0;
+        for(const auto& agent : agents) {
+            neighborhoodSearch.GetNeighboringAgents(agent.position(), 2.2, neighbors);
+            found += neighbors.size();
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmNeighborhoodSearchQuery)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "CollisionFreeSpeedModel.hpp"
+#include "CollisionGeometry.hpp"
+#include "GenericAgent.hpp"
+#include "GeometryBuilder.hpp"
+#include "NeighborhoodSearch.hpp"
+#include "OperationalDecisionSystem.hpp"
+#include "Point.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/// Collision free speed model agents on a square grid with 1 m spacing, all heading for the
+/// center of a square room.
+struct OperationalStepScenario {
+    CollisionGeometry geometry;
+    AgentContainer<GenericAgent> agents{};
+    NeighborhoodSearch<GenericAgent> neighborhoodSearch;
+
+    static CollisionGeometry buildRoom(double side)
+    {
+        GeometryBuilder builder;
+        builder.AddAccessibleArea(
+            std::vector<Point>{{-1, -1}, {side + 1, -1}, {side + 1, side + 1}, {-1, side + 1}});
+        return builder.Build();
+    }
+
+    explicit OperationalStepScenario(size_t agentCount)
+        : geometry(buildRoom(std::ceil(std::sqrt(static_cast<double>(agentCount)))))
+        , neighborhoodSearch(2.2, geometry.Bounds())
+    {
+        const auto columns = static_cast<size_t>(std::ceil(std::sqrt(agentCount)));
+        const Point center{columns / 2., columns / 2.};
+        for(size_t index = 0; index < agentCount; ++index) {
+            const Point position{
+                static_cast<double>(index % columns), static_cast<double>(index / columns)};
+            auto& agent = agents.emplace_back(
+                GenericAgent::ID::Invalid,
+                jps::UniqueID<Journey>::Invalid,
+                jps::UniqueID<BaseStage>::Invalid,
+                CollisionFreeSpeedModel::State{position});
+            agent.nextTarget = center;
+        }
+        neighborhoodSearch.Update(agents);
+    }
+};
+
+static std::unique_ptr<CollisionFreeSpeedModel> makeCollisionFreeSpeedModel()
+{
+    return std::make_unique<CollisionFreeSpeedModel>(8.0, 0.1, 5.0, 0.02);
+}
+
+/// Operational step as done before the next generation was recycled: the buffer is cleared and
+/// every agent is copied into it ahead of the model loop.
+static void bmOperationalStepCopyAll(benchmark::State& state)
+{
+    OperationalStepScenario scenario(static_cast<size_t>(state.range(0)));
+    const auto model = makeCollisionFreeSpeedModel();
+    AgentContainer<GenericAgent> next{};
+
+    for(auto _ : state) {
+        next.clear();
+        std::copy(
+            std::begin(scenario.agents), std::end(scenario.agents), std::back_inserter(next));
+        for(size_t index = 0; index < scenario.agents.size(); ++index) {
+            model->ComputeNextState(
+                0.01,
+                scenario.agents[index],
+                next[index],
+                scenario.geometry,
+                scenario.neighborhoodSearch);
+        }
+        scenario.agents.swap(next);
+        scenario.neighborhoodSearch.UpdatePositions(scenario.agents);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Operational step of OperationalDecisionSystem.
+static void bmOperationalStep(benchmark::State& state)
+{
+    OperationalStepScenario scenario(static_cast<size_t>(state.range(0)));
+    OperationalDecisionSystem system{makeCollisionFreeSpeedModel()};
+
+    for(auto _ : state) {
+        system.Run(0.01, 0, scenario.neighborhoodSearch, scenario.geometry, scenario.agents);
+        scenario.neighborhoodSearch.UpdatePositions(scenario.agents);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmOperationalStepCopyAll)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bmOperationalStep)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
@@ -2,15 +2,23 @@
 #pragma once
 
 #include "GenericAgent.hpp"
+#include "Stage.hpp"
 #include "StageManager.hpp"
 
 #include <algorithm>
-#include <map>
+#include <cstddef>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 template <typename Agent>
 class AgentRemovalSystem
 {
+    std::unordered_set<GenericAgent::ID> _removed{};
+    /// Number of removed agents per stage, stages are few so a linear search is sufficient.
+    std::vector<std::pair<BaseStage::ID, size_t>> _removedPerStage{};
+
 public:
     AgentRemovalSystem() = default;
     ~AgentRemovalSystem() = default;
@@ -19,32 +27,64 @@ public:
     AgentRemovalSystem(AgentRemovalSystem&& other) = delete;
     AgentRemovalSystem& operator=(AgentRemovalSystem&& other) = delete;
 
-    void
+    /// Removes all agents listed in 'removedAgentIds' in a single compaction pass that keeps the
+    /// order of the remaining agents, and clears 'removedAgentIds'.
+    /// @return index of the first removed agent, agents before it kept their index. Equals
+    /// 'agents.size()' if nothing was removed.
+    size_t
     Run(AgentContainer<Agent>& agents,
         std::vector<GenericAgent::ID>& removedAgentIds,
-        StageManager& stageManager) const;
+        StageManager& stageManager);
+
+private:
+    void countRemoval(BaseStage::ID stageId);
 };
 
 template <typename Agent>
-void AgentRemovalSystem<Agent>::Run(
+size_t AgentRemovalSystem<Agent>::Run(
     AgentContainer<Agent>& agents,
     std::vector<GenericAgent::ID>& removedAgentIds,
-    StageManager& stageManager) const
+    StageManager& stageManager)
 {
+    if(removedAgentIds.empty()) {
+        return agents.size();
+    }
+    _removed.clear();
+    _removed.insert(std::begin(removedAgentIds), std::end(removedAgentIds));
+    removedAgentIds.clear();
 
-    auto iter = std::remove_if(
-        std::begin(agents),
-        std::end(agents),
-        [&removedAgentIds, &stageManager](const GenericAgent& agent) {
-            auto found =
-                std::find(std::begin(removedAgentIds), std::end(removedAgentIds), agent.id) !=
-                std::end(removedAgentIds);
-            if(found) {
-                stageManager.HandleRemoveAgent(agent.stageId);
-            }
-            return found;
+    const auto first =
+        std::find_if(std::begin(agents), std::end(agents), [this](const Agent& agent) {
+            return _removed.contains(agent.id);
         });
+    const auto firstIndex = static_cast<size_t>(std::distance(std::begin(agents), first));
+
+    _removedPerStage.clear();
+    const auto iter = std::remove_if(first, std::end(agents), [this](const Agent& agent) {
+        if(_removed.contains(agent.id)) {
+            countRemoval(agent.stageId);
+            return true;
+        }
+        return false;
+    });
     agents.erase(iter, std::end(agents));
 
-    removedAgentIds.clear();
+    for(const auto& [stageId, count] : _removedPerStage) {
+        stageManager.HandleRemoveAgent(stageId, count);
+    }
+    return firstIndex;
+}
+
+template <typename Agent>
+void AgentRemovalSystem<Agent>::countRemoval(BaseStage::ID stageId)
+{
+    const auto iter = std::find_if(
+        std::begin(_removedPerStage), std::end(_removedPerStage), [stageId](const auto& entry) {
+            return entry.first == stageId;
+        });
+    if(iter != std::end(_removedPerStage)) {
+        ++iter->second;
+    } else {
+        _removedPerStage.emplace_back(stageId, 1);
+    }
 }
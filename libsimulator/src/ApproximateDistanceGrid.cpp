@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "ApproximateDistanceGrid.hpp"
+
+#include "AABB.hpp"
+#include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "Point.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+static int64_t cellIndexOf(double v, double cellSize)
+{
+    return static_cast<int64_t>(std::floor(v / cellSize));
+}
+
+static std::array<AABB, 4> quadrants(const AABB& bounds)
+{
+    const auto xmid = (bounds.xmin + bounds.xmax) / 2;
+    const auto ymid = (bounds.ymin + bounds.ymax) / 2;
+    return {
+        AABB{{bounds.xmin, bounds.ymin}, {xmid, ymid}},
+        AABB{{xmid, bounds.ymin}, {bounds.xmax, ymid}},
+        AABB{{bounds.xmin, ymid}, {xmid, bounds.ymax}},
+        AABB{{xmid, ymid}, {bounds.xmax, bounds.ymax}}};
+}
+
+ApproximateDistanceGrid::ApproximateDistanceGrid(
+    const std::vector<LineSegment>& segments,
+    double cellSize,
+    double searchRadius)
+    : _cellSize(cellSize), _searchRadius(searchRadius), _segments(segments)
+{
+    if(segments.empty()) {
+        return;
+    }
+
+    const AABB segmentBounds = [&segments]() {
+        std::vector<Point> points{};
+        points.reserve(2 * segments.size());
+        for(const auto& ls : segments) {
+            points.push_back(ls.p1);
+            points.push_back(ls.p2);
+        }
+        return AABB(points);
+    }();
+    _firstColumn = cellIndexOf(segmentBounds.xmin - _searchRadius, _cellSize);
+    _firstRow = cellIndexOf(segmentBounds.ymin - _searchRadius, _cellSize);
+    _columns = static_cast<size_t>(
+        cellIndexOf(segmentBounds.xmax + _searchRadius, _cellSize) - _firstColumn + 1);
+    _rows = static_cast<size_t>(
+        cellIndexOf(segmentBounds.ymax + _searchRadius, _cellSize) - _firstRow + 1);
+    _nodes.resize(_columns * _rows);
+
+    const auto cellBounds = [this](int64_t column, int64_t row) {
+        return AABB{
+            {static_cast<double>(column) * _cellSize, static_cast<double>(row) * _cellSize},
+            {static_cast<double>(column + 1) * _cellSize,
+             static_cast<double>(row + 1) * _cellSize}};
+    };
+    const auto nodeIndex = [this](int64_t column, int64_t row) {
+        return static_cast<size_t>(row - _firstRow) * _columns +
+               static_cast<size_t>(column - _firstColumn);
+    };
+
+    // Inserting one linesegment after the other keeps the order of 'segments' in every cell
+    for(uint32_t index = 0; index < segments.size(); ++index) {
+        const auto& ls = segments[index];
+        const auto lastColumn = cellIndexOf(std::max(ls.p1.x, ls.p2.x) + _searchRadius, _cellSize);
+        const auto lastRow = cellIndexOf(std::max(ls.p1.y, ls.p2.y) + _searchRadius, _cellSize);
+        for(auto row = cellIndexOf(std::min(ls.p1.y, ls.p2.y) - _searchRadius, _cellSize);
+            row <= lastRow;
+            ++row) {
+            for(auto column =
+                    cellIndexOf(std::min(ls.p1.x, ls.p2.x) - _searchRadius, _cellSize);
+                column <= lastColumn;
+                ++column) {
+                if(searchBounds(cellBounds(column, row)).Intersects(ls)) {
+                    _nodes[nodeIndex(column, row)].segments.push_back(index);
+                }
+            }
+        }
+    }
+
+    for(int64_t row = _firstRow; row < _firstRow + static_cast<int64_t>(_rows); ++row) {
+        for(int64_t column = _firstColumn; column < _firstColumn + static_cast<int64_t>(_columns);
+            ++column) {
+            refine(nodeIndex(column, row), cellBounds(column, row));
+        }
+    }
+
+    for(auto& node : _nodes) {
+        node.segments.shrink_to_fit();
+        std::vector<LineSegment> nodeSegments{};
+        nodeSegments.reserve(node.segments.size());
+        for(const auto index : node.segments) {
+            nodeSegments.push_back(_segments[index]);
+        }
+        node.block = LineSegmentBlock(nodeSegments);
+        if(node.firstChild == 0) {
+            ++_leafCount;
+        }
+    }
+}
+
+const ApproximateDistanceGrid::Node& ApproximateDistanceGrid::leafAt(Point p) const
+{
+    static const Node empty{};
+
+    const auto column = cellIndexOf(p.x, _cellSize);
+    const auto row = cellIndexOf(p.y, _cellSize);
+    if(column < _firstColumn || row < _firstRow ||
+       column >= _firstColumn + static_cast<int64_t>(_columns) ||
+       row >= _firstRow + static_cast<int64_t>(_rows)) {
+        return empty;
+    }
+
+    auto index = static_cast<size_t>(row - _firstRow) * _columns +
+                 static_cast<size_t>(column - _firstColumn);
+    // Bounds are halved the same way as during refinement, so that the descent picks exactly the
+    // quadrant the point was assigned to when the quadrant was built.
+    AABB bounds{
+        {static_cast<double>(column) * _cellSize, static_cast<double>(row) * _cellSize},
+        {static_cast<double>(column + 1) * _cellSize, static_cast<double>(row + 1) * _cellSize}};
+    while(_nodes[index].firstChild != 0) {
+        const auto right = p.x >= (bounds.xmin + bounds.xmax) / 2;
+        const auto top = p.y >= (bounds.ymin + bounds.ymax) / 2;
+        const auto quadrant = static_cast<size_t>(right) + 2 * static_cast<size_t>(top);
+        bounds = quadrants(bounds)[quadrant];
+        index = _nodes[index].firstChild + quadrant;
+    }
+    return _nodes[index];
+}
+
+void ApproximateDistanceGrid::refine(size_t node, AABB bounds)
+{
+    const auto& segments = _nodes[node].segments;
+    if(segments.size() <= MAX_SEGMENTS_PER_LEAF ||
+       (bounds.xmax - bounds.xmin) / 2 < MIN_LEAF_SIZE) {
+        return;
+    }
+
+    const auto children = quadrants(bounds);
+    std::array<std::vector<uint32_t>, 4> childSegments{};
+    for(size_t quadrant = 0; quadrant < children.size(); ++quadrant) {
+        const auto search = searchBounds(children[quadrant]);
+        std::copy_if(
+            std::begin(segments),
+            std::end(segments),
+            std::back_inserter(childSegments[quadrant]),
+            [this, &search](auto index) { return search.Intersects(_segments[index]); });
+    }
+    // Splitting only pays off if at least one quadrant gets a shorter list
+    if(std::all_of(std::begin(childSegments), std::end(childSegments), [&segments](auto& c) {
+           return c.size() == segments.size();
+       })) {
+        return;
+    }
+
+    const auto firstChild = _nodes.size();
+    _nodes[node].firstChild = static_cast<uint32_t>(firstChild);
+    _nodes[node].segments = {};
+    for(auto& childSegment : childSegments) {
+        _nodes.push_back(Node{std::move(childSegment)});
+    }
+    for(size_t quadrant = 0; quadrant < children.size(); ++quadrant) {
+        refine(firstChild + quadrant, children[quadrant]);
+    }
+}
+
+AABB ApproximateDistanceGrid::searchBounds(const AABB& cell) const
+{
+    return AABB{
+        {cell.xmin - _searchRadius, cell.ymin - _searchRadius},
+        {cell.xmax + _searchRadius, cell.ymax + _searchRadius}};
+}
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "Point.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+/// Lists for every point all linesegments that may be within 'searchRadius' of it.
+///
+/// The area around the linesegments is covered by square base cells addressed by integer column
+/// and row, cell (column, row) covers [column * cellSize, (column + 1) * cellSize) x
+/// [row * cellSize, (row + 1) * cellSize). A cell lists every linesegment intersecting the cell
+/// grown by 'searchRadius' on all sides, in the order the linesegments were passed in. Cells
+/// listing many linesegments are split into quadrants recursively, so that points in dense
+/// regions get shorter lists. Cells store the indices of their linesegments, the linesegments
+/// themselves are stored once.
+class ApproximateDistanceGrid
+{
+public:
+    /// Maps an index of a linesegment to the linesegment.
+    struct SegmentAt {
+        const std::vector<LineSegment>* segments{};
+
+        const LineSegment& operator()(uint32_t index) const { return (*segments)[index]; }
+    };
+    using SegmentRange = std::ranges::
+        transform_view<std::ranges::ref_view<const std::vector<uint32_t>>, SegmentAt>;
+
+private:
+    struct Node {
+        /// Indices into '_segments' in ascending order.
+        std::vector<uint32_t> segments{};
+        /// Same linesegments as 'segments' for the vectorized distance computation.
+        LineSegmentBlock block{};
+        /// Index of the first of four children in '_nodes', 0 for leaves. Children are ordered
+        /// bottom left, bottom right, top left, top right.
+        uint32_t firstChild{0};
+    };
+
+    double _cellSize{1};
+    double _searchRadius{0};
+    int64_t _firstColumn{0};
+    int64_t _firstRow{0};
+    size_t _columns{0};
+    size_t _rows{0};
+    std::vector<LineSegment> _segments{};
+    /// Base cells in row major order followed by all children created by refinement.
+    std::vector<Node> _nodes{};
+    size_t _leafCount{0};
+
+public:
+    /// Leaves listing more linesegments than this are split into quadrants.
+    static constexpr size_t MAX_SEGMENTS_PER_LEAF = 32;
+    /// Leaves are not split below this edge length in meters.
+    static constexpr double MIN_LEAF_SIZE = 0.5;
+
+    ApproximateDistanceGrid() = default;
+    /// Creates a grid covering all points within 'searchRadius' of any of 'segments'.
+    /// @param segments linesegments to insert
+    /// @param cellSize edge length of a base cell
+    /// @param searchRadius every linesegment closer than this to a point is listed for the point
+    ApproximateDistanceGrid(
+        const std::vector<LineSegment>& segments,
+        double cellSize,
+        double searchRadius);
+
+    double CellSize() const { return _cellSize; }
+
+    double SearchRadius() const { return _searchRadius; }
+
+    /// Number of base cells and quadrants that were not split any further.
+    size_t LeafCount() const { return _leafCount; }
+
+    /// All linesegments that may be within the search radius of 'p', empty if there are none.
+    /// May contain linesegments that are farther away.
+    SegmentRange SegmentsNear(Point p) const
+    {
+        return SegmentRange(std::ranges::ref_view(leafAt(p).segments), SegmentAt{&_segments});
+    }
+
+    /// Same linesegments as 'SegmentsNear' stored as structure of arrays.
+    const LineSegmentBlock& BlockNear(Point p) const { return leafAt(p).block; }
+
+private:
+    const Node& leafAt(Point p) const;
+    void refine(size_t node, AABB bounds);
+    AABB searchBounds(const AABB& cell) const;
+};
@@ -12,6 +12,7 @@
 
 #include <cstddef>
 #include <functional>
+#include <limits>
 #include <list>
 #include <sstream>
 #include <string>
@@ -29,6 +30,7 @@ template <class Gt, class Fb = CGAL::Constrained_triangulation_face_base_2<Gt>>
 class MyFace : public Fb
 {
     bool in{false};
+    size_t index{std::numeric_limits<size_t>::max()};
     typedef Fb Base;
     typedef typename Fb::Triangulation_data_structure TDS;
 
@@ -41,6 +43,9 @@ public:
     };
     void set_in_domain(bool v) { in = v; }
     bool get_in_domain() const { return in; }
+    /// Position of the face among all faces in the domain, assigned by 'RoutingEngine'.
+    void set_index(size_t v) { index = v; }
+    size_t get_index() const { return index; }
 };
 using TDS = CGAL::Triangulation_data_structure_2<Vb, MyFace<K>>;
 using Itag = CGAL::Exact_predicates_tag;
@@ -2,76 +2,80 @@
 #include "CollisionGeometry.hpp"
 
 #include "AABB.hpp"
+#include "ApproximateDistanceGrid.hpp"
 #include "CfgCgal.hpp"
 #include "GeometricFunctions.hpp"
+#include "GeometryHash.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "LineSegmentGrid.hpp"
 #include "Point.hpp"
+#include "SimulationError.hpp"
+#include "WallDistanceField.hpp"
 
 #include <CGAL/Boolean_set_operations_2/oriented_side.h>
 #include <CGAL/enum.h>
 #include <CGAL/number_utils.h>
+#include <fmt/format.h>
 
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
-#include <set>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
-Cell makeCell(Point p)
-{
-    return {floor(p.x / CELL_EXTEND) * CELL_EXTEND, floor(p.y / CELL_EXTEND) * CELL_EXTEND};
-}
+/// Preferred edge length of a cell in the coverage raster.
+constexpr double COVERAGE_CELL_SIZE = 0.25;
+/// Upper bound for the number of cells in the coverage raster, large geometries use coarser cells.
+constexpr double MAX_COVERAGE_CELLS = 1 << 22;
+/// Walls farther away do not contribute to boundary repulsion, same as the search radius of the
+/// approximate grid.
+constexpr double WALL_DISTANCE_FIELD_MAX_DISTANCE = APPROXIMATE_SEARCH_RADIUS;
+/// Range of automatically chosen grid cell sizes.
+constexpr double MIN_AUTOMATIC_CELL_SIZE = 1.;
+constexpr double MAX_AUTOMATIC_CELL_SIZE = 4.;
 
-bool IsN8Adjacent(const Cell& a, const Cell& b)
+/// Writes the accessible area as WKT polygon with closed rings. Coordinates are written with the
+/// shortest representation that reads back to the same double.
+static std::string
+wktOf(const std::vector<Point>& exterior, const std::vector<std::vector<Point>>& holes)
 {
-    const auto dx = static_cast<int>(abs(a.x - b.x) / CELL_EXTEND);
-    const auto dy = static_cast<int>(abs(a.y - b.y) / CELL_EXTEND);
-    if((dx == 0 && dy == 0) || dx > 1 || dy > 1) {
-        return false;
+    fmt::memory_buffer wkt{};
+    const auto appendRing = [&wkt](const std::vector<Point>& ring) {
+        wkt.push_back('(');
+        for(const auto& p : ring) {
+            fmt::format_to(std::back_inserter(wkt), "{} {}, ", p.x, p.y);
+        }
+        fmt::format_to(std::back_inserter(wkt), "{} {})", ring.front().x, ring.front().y);
+    };
+    fmt::format_to(std::back_inserter(wkt), "POLYGON (");
+    appendRing(exterior);
+    for(const auto& hole : holes) {
+        fmt::format_to(std::back_inserter(wkt), ", ");
+        appendRing(hole);
     }
-    return true;
+    wkt.push_back(')');
+    return fmt::to_string(wkt);
 }
 
-std::set<Cell> cellsFromLineSegment(LineSegment ls)
+/// Chooses a cell size such that a cell contains about one linesegment on average.
+static double automaticCellSize(const AABB& bounds, size_t segmentCount)
 {
-    const auto firstCell = makeCell(ls.p1);
-    const auto lastCell = makeCell(ls.p2);
-    if(firstCell == lastCell) {
-        return {firstCell};
-    }
-
-    if(IsN8Adjacent(firstCell, lastCell)) {
-        return {firstCell, lastCell};
-    }
-
-    std::set<Cell> cells{firstCell, lastCell};
-
-    const auto toMultiple = [](double x) { return ceil(x / CELL_EXTEND) * CELL_EXTEND; };
-    const AABB bounds(ls.p1, ls.p2);
-    const auto vec_p1p2 = ls.p2 - ls.p1;
-    std::vector<Point> intersections{};
-    for(double x_intersect = toMultiple(bounds.xmin); x_intersect <= bounds.xmax;
-        x_intersect += CELL_EXTEND) {
-        const double fact = (x_intersect - ls.p1.x) / vec_p1p2.x;
-        intersections.emplace_back(x_intersect, ls.p1.y + fact * vec_p1p2.y);
-    }
-    for(double y_intersect = toMultiple(bounds.ymin); y_intersect <= bounds.ymax;
-        y_intersect += CELL_EXTEND) {
-        const double fact = (y_intersect - ls.p1.y) / vec_p1p2.y;
-        intersections.emplace_back(ls.p1.x + fact * vec_p1p2.x, y_intersect);
-    }
-    std::sort(std::begin(intersections), std::end(intersections));
-    for(size_t index = 1; index < intersections.size(); ++index) {
-        cells.insert(makeCell((intersections[index - 1] + intersections[index]) / 2));
-    }
-    return cells;
+    const auto area = (bounds.xmax - bounds.xmin) * (bounds.ymax - bounds.ymin);
+    return std::clamp(
+        std::sqrt(area / static_cast<double>(std::max<size_t>(segmentCount, 1))),
+        MIN_AUTOMATIC_CELL_SIZE,
+        MAX_AUTOMATIC_CELL_SIZE);
 }
 
+/// Same distance as computed by 'LineSegmentBlock::ClosestPointsTo'.
 double dist(LineSegment l, Point p)
 {
-    return l.DistTo(p);
+    return (l.ShortestPoint(p) - p).Norm();
 }
 
 size_t CountLineSegments(const PolyWithHoles& poly)
@@ -97,28 +101,19 @@ void ExtractSegmentsFromPolygon(const Poly& p, std::vector<LineSegment>& segment
     segments.emplace_back(fromPoint_2(boundary.back()), fromPoint_2(boundary.front()));
 }
 
-CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
+CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea, double cellSize)
     : _accessibleAreaPolygon(accessibleArea)
 {
+    if(cellSize < 0) {
+        throw SimulationError("Grid cell size needs to be positive or 0, got {}", cellSize);
+    }
+
     _segments.reserve(CountLineSegments(accessibleArea));
     ExtractSegmentsFromPolygon(accessibleArea.outer_boundary(), _segments);
     for(const auto& hole : accessibleArea.holes()) {
         ExtractSegmentsFromPolygon(hole, _segments);
     }
 
-    for(const auto& ls : _segments) {
-        const auto cells = cellsFromLineSegment(ls);
-        for(const auto& cell : cells) {
-            _grid[cell].insert(ls);
-        }
-
-        insertIntoApproximateGrid(ls);
-    }
-
-    for(auto& [_, vec] : _approximateGrid) {
-        vec.shrink_to_fit();
-    }
-
     const auto cvt = [](const auto& c) {
         std::vector<Point> out{};
         out.reserve(c.size());
@@ -128,6 +123,7 @@ CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
         return out;
     };
     std::vector<Point> exterior = cvt(_accessibleAreaPolygon.outer_boundary().container());
+    _bounds = AABB(exterior);
     std::vector<std::vector<Point>> holes{};
     holes.reserve(_accessibleAreaPolygon.holes().size());
     std::transform(
@@ -135,77 +131,226 @@ CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
         std::end(_accessibleAreaPolygon.holes()),
         std::back_inserter(holes),
         [&cvt](auto&& c) { return cvt(c); });
+    _wkt = wktOf(exterior, holes);
+    _hash = GeometryHash(_accessibleAreaPolygon);
     _accessibleArea = std::make_tuple(exterior, holes);
+
+    if(cellSize == 0) {
+        cellSize = automaticCellSize(_bounds, _segments.size());
+    }
+    _grid = LineSegmentGrid(_segments, cellSize);
+    _approximateGrid = ApproximateDistanceGrid(_segments, cellSize, APPROXIMATE_SEARCH_RADIUS);
+    _segmentBlock = LineSegmentBlock(_segments);
+
+    buildCoverage();
 }
 
-const std::vector<LineSegment>& CollisionGeometry::LineSegmentsInApproxDistanceTo(Point p) const
+ApproximateDistanceGrid::SegmentRange
+CollisionGeometry::LineSegmentsInApproxDistanceTo(Point p) const
 {
-    const auto cell = makeCell(p);
-    if(const auto it = _approximateGrid.find(cell); it != _approximateGrid.end()) {
-        return it->second;
-    }
-    static const std::vector<LineSegment> empty{};
-    return empty;
+    return _approximateGrid.SegmentsNear(p);
 }
 
-void CollisionGeometry::insertIntoApproximateGrid(const LineSegment& ls)
+const LineSegmentBlock& CollisionGeometry::LineSegmentBlockInApproxDistanceTo(Point p) const
 {
-    constexpr double searchRadius = 4.;
+    return _approximateGrid.BlockNear(p);
+}
 
-    const auto searchExtend = Point(searchRadius, searchRadius);
-    const AABB lineSegmentBounds({ls.p1, ls.p2});
-    const AABB searchBounds(
-        lineSegmentBounds.BottomLeft() - searchExtend, lineSegmentBounds.TopRight() + searchExtend);
+std::vector<LineSegment> CollisionGeometry::LineSegmentsInDistanceTo(double distance, Point p) const
+{
+    std::vector<LineSegment> result{};
+    const auto inRange = [distance, p](const LineSegment& ls) { return dist(ls, p) <= distance; };
 
-    auto cellBottomLeft = makeCell(searchBounds.BottomLeft());
-    auto cellTopRight = makeCell(searchBounds.TopRight());
+    const auto firstColumn = _grid.Column(p.x - distance);
+    const auto lastColumn = _grid.Column(p.x + distance);
+    const auto firstRow = _grid.Row(p.y - distance);
+    const auto lastRow = _grid.Row(p.y + distance);
+    const auto cellCount = static_cast<double>(lastColumn - firstColumn + 1) *
+                           static_cast<double>(lastRow - firstRow + 1);
 
-    for(double x = cellBottomLeft.x; x <= cellTopRight.x; x += CELL_EXTEND) {
-        for(double y = cellBottomLeft.y; y <= cellTopRight.y; y += CELL_EXTEND) {
-            const auto cell = makeCell({x, y});
+    // Large query areas are cheaper to answer by testing all segments than by probing
+    // mostly empty cells.
+    if(cellCount > static_cast<double>(std::min(_grid.CellCount(), _segments.size()))) {
+        thread_local ClosestPoints closest{};
+        _segmentBlock.ClosestPointsTo(p, closest);
+        for(size_t index = 0; index < closest.Size(); ++index) {
+            if(closest.distance[index] <= distance) {
+                result.push_back(_segments[index]);
+            }
+        }
+        return result;
+    }
 
-            const AABB bbWithSearchRadius(
-                {cell.x - searchRadius, cell.y - searchRadius},
-                {cell.x + searchRadius + CELL_EXTEND, cell.y + searchRadius + CELL_EXTEND});
+    // Reused between calls, this runs once per agent and step
+    thread_local std::vector<uint32_t> candidates{};
+    candidates.clear();
+    for(auto row = firstRow; row <= lastRow; ++row) {
+        for(auto column = firstColumn; column <= lastColumn; ++column) {
+            const auto cell = _grid.SegmentsInCell(column, row);
+            candidates.insert(std::end(candidates), cell.begin(), cell.end());
+        }
+    }
+    // Segments spanning multiple cells are found more than once
+    std::sort(std::begin(candidates), std::end(candidates));
+    candidates.erase(
+        std::unique(std::begin(candidates), std::end(candidates)), std::end(candidates));
 
-            if(bbWithSearchRadius.Intersects(ls)) {
-                auto& vec = _approximateGrid[cell];
-                vec.push_back(ls);
-            }
+    for(const auto index : candidates) {
+        if(inRange(_segments[index])) {
+            result.push_back(_segments[index]);
         }
     }
+    return result;
 }
 
-CollisionGeometry::LineSegmentRange
-CollisionGeometry::LineSegmentsInDistanceTo(double distance, Point p) const
+bool CollisionGeometry::IntersectsAny(const LineSegment& linesegment) const
 {
-    return LineSegmentRange{
-        DistanceQueryIterator<LineSegment>{distance, p, _segments.cbegin(), _segments.cend()},
-        DistanceQueryIterator<LineSegment>{distance, p, _segments.cend(), _segments.cend()}};
+    return _grid.ForEachCellAlong(linesegment, [this, &linesegment](int64_t column, int64_t row) {
+        const auto cell = _grid.SegmentsInCell(column, row);
+        return std::any_of(cell.begin(), cell.end(), [this, &linesegment](auto index) {
+            return intersects(linesegment, _segments[index]);
+        });
+    });
 }
 
-bool CollisionGeometry::IntersectsAny(const LineSegment& linesegment) const
+void CollisionGeometry::BuildWallDistanceField(double resolution)
 {
-    const auto cellsToQuery = cellsFromLineSegment(linesegment);
-    for(const auto& cell : cellsToQuery) {
-        const auto iter = _grid.find(cell);
-        if(iter == std::end(_grid)) {
-            continue;
-        }
-        if(std::find_if(
-               iter->second.cbegin(), iter->second.cend(), [&linesegment](const auto candidate) {
-                   return intersects(linesegment, candidate);
-               }) != iter->second.end()) {
+    if(resolution < 0) {
+        throw SimulationError(
+            "Wall distance field resolution needs to be positive or 0, got {}", resolution);
+    }
+    if(resolution == 0) {
+        _wallDistanceField.reset();
+        return;
+    }
+    _wallDistanceField = std::make_shared<const WallDistanceField>(
+        *this, resolution, WALL_DISTANCE_FIELD_MAX_DISTANCE);
+}
+
+bool CollisionGeometry::InsideGeometry(Point p) const
+{
+    if(!_bounds.Inside(p)) {
+        return false;
+    }
+    switch(_coverage[coverageRow(p.y) * _coverageColumns + coverageColumn(p.x)]) {
+        case Coverage::Inside:
             return true;
+        case Coverage::Outside:
+            return false;
+        case Coverage::Boundary:
+            break;
+    }
+    return insideByCrossings(p);
+}
+
+void CollisionGeometry::buildCoverage()
+{
+    const auto width = _bounds.xmax - _bounds.xmin;
+    const auto height = _bounds.ymax - _bounds.ymin;
+    _coverageCellSize =
+        std::max(COVERAGE_CELL_SIZE, std::sqrt(width * height / MAX_COVERAGE_CELLS));
+    _coverageColumns = static_cast<size_t>(width / _coverageCellSize) + 1;
+    _coverageRows = static_cast<size_t>(height / _coverageCellSize) + 1;
+    _coverage.assign(_coverageColumns * _coverageRows, Coverage::Outside);
+
+    // Cells touched by a linesegment are boundary cells. The touched range is widened by a small
+    // margin so that rounding can never hide a linesegment from the cell it passes through.
+    const auto margin = _coverageCellSize * 1e-6;
+    const auto rowCenter = [this](size_t row) {
+        return _bounds.ymin + (static_cast<double>(row) + 0.5) * _coverageCellSize;
+    };
+    // All x coordinates at which the horizontal line through the center of a row crosses the
+    // boundary of the accessible area.
+    std::vector<std::vector<double>> crossings(_coverageRows);
+    _coverageRowSegments.assign(_coverageRows, {});
+    for(size_t index = 0; index < _segments.size(); ++index) {
+        const auto& ls = _segments[index];
+        const auto yLow = std::min(ls.p1.y, ls.p2.y);
+        const auto yHigh = std::max(ls.p1.y, ls.p2.y);
+        const auto xAt = [&ls](double y) {
+            return ls.p1.x + (y - ls.p1.y) * (ls.p2.x - ls.p1.x) / (ls.p2.y - ls.p1.y);
+        };
+        for(size_t row = coverageRow(yLow); row <= coverageRow(yHigh); ++row) {
+            _coverageRowSegments[row].push_back(static_cast<uint32_t>(index));
+        }
+
+        const auto lastRow = coverageRow(yHigh + margin);
+        for(size_t row = coverageRow(yLow - margin); row <= lastRow; ++row) {
+            const auto rowBottom = _bounds.ymin + static_cast<double>(row) * _coverageCellSize;
+            const auto xA = ls.p1.y == ls.p2.y ? ls.p1.x : xAt(std::clamp(rowBottom, yLow, yHigh));
+            const auto xB = ls.p1.y == ls.p2.y ?
+                                ls.p2.x :
+                                xAt(std::clamp(rowBottom + _coverageCellSize, yLow, yHigh));
+            const auto lastColumn = coverageColumn(std::max(xA, xB) + margin);
+            for(size_t column = coverageColumn(std::min(xA, xB) - margin); column <= lastColumn;
+                ++column) {
+                _coverage[row * _coverageColumns + column] = Coverage::Boundary;
+            }
+
+            const auto y = rowCenter(row);
+            if((ls.p1.y > y) != (ls.p2.y > y)) {
+                crossings[row].push_back(xAt(y));
+            }
+        }
+    }
+
+    // All other cells are classified by the parity of boundary crossings left of their center.
+    for(size_t row = 0; row < _coverageRows; ++row) {
+        auto& xs = crossings[row];
+        std::sort(std::begin(xs), std::end(xs));
+        size_t crossed = 0;
+        for(size_t column = 0; column < _coverageColumns; ++column) {
+            const auto x = _bounds.xmin + (static_cast<double>(column) + 0.5) * _coverageCellSize;
+            while(crossed < xs.size() && xs[crossed] < x) {
+                ++crossed;
+            }
+            auto& coverage = _coverage[row * _coverageColumns + column];
+            if(coverage != Coverage::Boundary) {
+                coverage = crossed % 2 == 1 ? Coverage::Inside : Coverage::Outside;
+            }
         }
     }
-    return false;
 }
 
-bool CollisionGeometry::InsideGeometry(Point p) const
+size_t CollisionGeometry::coverageColumn(double x) const
+{
+    const auto column = std::floor((x - _bounds.xmin) / _coverageCellSize);
+    return static_cast<size_t>(
+        std::clamp(column, 0., static_cast<double>(_coverageColumns - 1)));
+}
+
+size_t CollisionGeometry::coverageRow(double y) const
+{
+    const auto row = std::floor((y - _bounds.ymin) / _coverageCellSize);
+    return static_cast<size_t>(std::clamp(row, 0., static_cast<double>(_coverageRows - 1)));
+}
+
+bool CollisionGeometry::insideByCrossings(Point p) const
 {
-    return CGAL::oriented_side(K::Point_2(p.x, p.y), _accessibleAreaPolygon) !=
-           CGAL::ON_NEGATIVE_SIDE;
+    // Counts the linesegments crossing the ray from 'p' in negative x direction. Every linesegment
+    // reaching the y coordinate of 'p' is listed for the row of 'p'.
+    // Points within rounding distance of a linesegment are left to the CGAL predicate used for
+    // the whole polygon, so that points on walls are classified as before.
+    const auto margin = _coverageCellSize * 1e-6;
+    bool inside = false;
+    for(const auto index : _coverageRowSegments[coverageRow(p.y)]) {
+        const auto& ls = _segments[index];
+        const auto side = (ls.p2 - ls.p1).CrossProduct(p - ls.p1);
+        const AABB box{ls.p1, ls.p2};
+        if(std::abs(side) <= margin * Distance(ls.p1, ls.p2) && p.x >= box.xmin - margin &&
+           p.x <= box.xmax + margin && p.y >= box.ymin - margin && p.y <= box.ymax + margin) {
+            return CGAL::oriented_side(K::Point_2(p.x, p.y), _accessibleAreaPolygon) !=
+                   CGAL::ON_NEGATIVE_SIDE;
+        }
+        if((ls.p1.y > p.y) != (ls.p2.y > p.y)) {
+            // The crossing is left of 'p' if 'p' is right of the upward directed linesegment
+            const auto right = ls.p2.y > ls.p1.y ? side < 0 : side > 0;
+            if(right) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
 }
 
 const std::tuple<std::vector<Point>, std::vector<std::vector<Point>>>&
@@ -1,111 +1,64 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AABB.hpp"
+#include "ApproximateDistanceGrid.hpp"
 #include "CfgCgal.hpp"
-#include "HashCombine.hpp"
-#include "IteratorPair.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "LineSegmentGrid.hpp"
 #include "Point.hpp"
 #include "UniqueID.hpp"
+#include "WallDistanceField.hpp"
 
 #include <cstddef>
-#include <functional>
-#include <iterator>
-#include <set>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 
-class CollisionGeometry;
-
-double dist(LineSegment l, Point p);
-
-template <typename T>
-class DistanceQueryIterator
-{
-private:
-    using BackingIterator = typename std::vector<T>::const_iterator;
-    double _distance;
-    Point _p;
-    BackingIterator _current;
-    BackingIterator _end;
-
-public:
-    using iterator_category = std::input_iterator_tag;
-    using value_type = T;
-    using difference_type = std::ptrdiff_t;
-    using pointer = T*;
-    using reference = T&;
-    DistanceQueryIterator(double distance, Point p, BackingIterator current, BackingIterator end)
-        : _distance(distance)
-        , _p(p)
-        , _current(
-              std::find_if(
-                  current,
-                  end,
-                  [this](const auto& t) { return dist(t, _p) <= _distance; }))
-        , _end(end)
-    {
-    }
-    ~DistanceQueryIterator() = default;
-    DistanceQueryIterator(const DistanceQueryIterator& other) = default;
-    DistanceQueryIterator& operator=(const DistanceQueryIterator& other) = default;
-
-    bool operator==(const DistanceQueryIterator& other) const { return _current == other._current; }
-
-    bool operator!=(const DistanceQueryIterator& other) const { return !(*this == other); }
-
-    DistanceQueryIterator& operator++()
-    {
-        do {
-            ++_current;
-        } while(_current != _end && dist(*_current, _p) > _distance);
-        return *this;
-    }
-
-    const T& operator*() const { return *_current; }
-};
-
-/// Encodes a cell in the geometry grid.
-/// Cells are defined on the intervalls [min.x, min.x + extend), [min.y, min.y + extend)
-const int CELL_EXTEND = 4;
-using Cell = Point;
-
-/// Checks if two Cells are N8 neighbors. 'a' and 'b' are not considered neighbors if they have the
-/// same coordinates.
-bool IsN8Adjacent(const Cell& a, const Cell& b);
-
-/// Creates a cell from a position.
-/// Cells are always alligned to multiples of CELL_EXTEND. Cells are defined in worldcoordinates NOT
-/// indices.
-Cell makeCell(Point p);
-
-template <>
-struct std::hash<Cell> {
-    std::size_t operator()(const Point& pos) const noexcept
-    {
-        std::hash<double> hasher{};
-        return jps::hash_combine(hasher(pos.x), hasher(pos.y));
-    }
-};
-
-/// Creates all cells that are trouched by the linesegment
-std::set<Cell> cellsFromLineSegment(LineSegment ls);
+/// Every linesegment closer than this to a point is returned by
+/// 'CollisionGeometry::LineSegmentsInApproxDistanceTo'.
+constexpr double APPROXIMATE_SEARCH_RADIUS = 4.;
 
 class CollisionGeometry
 {
 private:
+    /// Classification of a cell in the coverage raster.
+    enum class Coverage : uint8_t { Outside, Inside, Boundary };
+
     PolyWithHoles _accessibleAreaPolygon;
     std::vector<LineSegment> _segments;
-    std::unordered_map<Cell, std::set<LineSegment>> _grid{};
-    std::unordered_map<Cell, std::vector<LineSegment>> _approximateGrid{};
+    /// Indices into '_segments' of all segments touching a cell.
+    LineSegmentGrid _grid{};
+    ApproximateDistanceGrid _approximateGrid{};
+    /// All of '_segments' for vectorized distance computations.
+    LineSegmentBlock _segmentBlock{};
     std::tuple<std::vector<Point>, std::vector<std::vector<Point>>> _accessibleArea{};
+    AABB _bounds{};
+    /// Raster over '_bounds' used to answer 'InsideGeometry' without the full polygon test.
+    /// Cells without any linesegment are entirely inside or outside the accessible area, only
+    /// points in boundary cells need to be tested against the linesegments of their row.
+    std::vector<Coverage> _coverage{};
+    /// Indices into '_segments' of all segments overlapping a raster row in y.
+    std::vector<std::vector<uint32_t>> _coverageRowSegments{};
+    double _coverageCellSize{};
+    size_t _coverageColumns{};
+    size_t _coverageRows{};
+    /// See 'GeometryHash'.
+    uint64_t _hash{};
+    /// Accessible area as WKT, serialized once as geometries do not change after construction.
+    std::string _wkt{};
+    /// Optional, shared between copies as it is never modified after construction.
+    std::shared_ptr<const WallDistanceField> _wallDistanceField{};
 
 public:
-    using LineSegmentRange = IteratorPair<DistanceQueryIterator<LineSegment>>;
     /// Do not call constructor drectly use 'GeometryBuilder'
-    /// @param segments line segments constituting the geometry
-    explicit CollisionGeometry(PolyWithHoles accessibleArea);
+    /// @param accessibleArea polygon constituting the geometry
+    /// @param cellSize edge length of the cells of the geometry grids in meters, 0 chooses the
+    /// size from the density of linesegments
+    explicit CollisionGeometry(PolyWithHoles accessibleArea, double cellSize = 0);
     /// Default destructor
     ~CollisionGeometry() = default;
     /// Copyable
@@ -116,13 +69,24 @@ public:
     CollisionGeometry(CollisionGeometry&& other) = default;
     /// Moveable
     CollisionGeometry& operator=(CollisionGeometry&& other) = default;
-    /// Returns an iterator pair to all linesegments <= 'distance' away from 'p'
+    /// Returns all linesegments <= 'distance' away from 'p'. Only segments in grid cells close to
+    /// 'p' are tested, the result keeps the order of the segments in the geometry.
     /// @param distance from reference point
     /// @param p reference point
-    /// @return iterator_pair to all linesegments in range
-    LineSegmentRange LineSegmentsInDistanceTo(double distance, Point p) const;
+    /// @return all linesegments in range
+    std::vector<LineSegment> LineSegmentsInDistanceTo(double distance, Point p) const;
 
-    const std::vector<LineSegment>& LineSegmentsInApproxDistanceTo(Point p) const;
+    /// Returns all linesegments that may be within 'APPROXIMATE_SEARCH_RADIUS' of 'p', the result
+    /// may contain linesegments that are farther away.
+    /// @param p reference point
+    /// @return linesegments in approximate range, in the order of the segments in the geometry
+    ApproximateDistanceGrid::SegmentRange LineSegmentsInApproxDistanceTo(Point p) const;
+
+    /// Same linesegments as 'LineSegmentsInApproxDistanceTo' stored as structure of arrays, to
+    /// compute the closest points of 'p' on all of them at once.
+    /// @param p reference point
+    /// @return linesegments in approximate range, in the order of the segments in the geometry
+    const LineSegmentBlock& LineSegmentBlockInApproxDistanceTo(Point p) const;
 
     /// Will perfrom a linesegment intersection versus the whole geometry, i.e. walls and closed
     /// doors.
@@ -130,12 +94,43 @@ public:
     /// @return if any linesegment of the geometry was intersected.
     bool IntersectsAny(const LineSegment& linesegment) const;
 
+    /// Checks if 'p' is inside the accessible area, points on the boundary are considered inside.
+    /// Only points close to the boundary are tested against linesegments.
+    /// @param p point to test
+    /// @return if 'p' is inside the accessible area
     bool InsideGeometry(Point p) const;
 
     const std::tuple<std::vector<Point>, std::vector<std::vector<Point>>>& AccessibleArea() const;
 
     const PolyWithHoles& Polygon() const { return _accessibleAreaPolygon; }
 
+    /// Stable hash of the accessible area, equal hashes identify equal accessible areas.
+    uint64_t Hash() const { return _hash; }
+
+    /// Accessible area as WKT polygon.
+    const std::string& Wkt() const { return _wkt; }
+
+    /// Axis aligned bounding box of the accessible area.
+    const AABB& Bounds() const { return _bounds; }
+
+    /// Edge length of the cells of the geometry grids in meters.
+    double CellSize() const { return _grid.CellSize(); }
+
+    /// All linesegments of the geometry, i.e. the outer boundary followed by all holes.
+    const std::vector<LineSegment>& LineSegments() const { return _segments; }
+
+    /// Samples the signed distance to the walls on a grid with 'resolution' meters between nodes.
+    /// Models use the field for boundary repulsion instead of iterating nearby linesegments.
+    /// @param resolution distance between nodes in meters, 0 removes the field
+    void BuildWallDistanceField(double resolution);
+
+    /// Wall distance field of the geometry.
+    /// @return the field or nullptr if none was built
+    const WallDistanceField* WallDistances() const { return _wallDistanceField.get(); }
+
 private:
-    void insertIntoApproximateGrid(const LineSegment& ls);
+    void buildCoverage();
+    size_t coverageColumn(double x) const;
+    size_t coverageRow(double y) const;
+    bool insideByCrossings(Point p) const;
 };
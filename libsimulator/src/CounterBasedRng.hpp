@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/// Stateless counter based random number generator built on Philox4x32-10
+/// (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011).
+///
+/// Every generator is a pure function of (seed, stream, counter). Models use the agent id as
+/// stream and a per-agent step counter as counter, so the numbers drawn for an agent do not
+/// depend on the order in which agents are processed or on the number of threads used.
+///
+/// Satisfies UniformRandomBitGenerator and can be used with the std distributions.
+class CounterBasedRng
+{
+public:
+    using result_type = std::uint32_t;
+    using Block = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+private:
+    Key _key;
+    Block _counter;
+    Block _block{};
+    size_t _index{_block.size()};
+
+public:
+    /// @param seed model wide seed
+    /// @param stream independent stream, e.g. the agent id
+    /// @param counter position in the stream, e.g. the step number of the agent. Only the lower
+    /// 32 bits are used.
+    CounterBasedRng(std::uint64_t seed, std::uint64_t stream, std::uint64_t counter)
+        : _key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}
+        , _counter{
+              0,
+              static_cast<std::uint32_t>(counter),
+              static_cast<std::uint32_t>(stream),
+              static_cast<std::uint32_t>(stream >> 32)}
+    {
+    }
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        if(_index == _block.size()) {
+            _block = Philox4x32(_counter, _key);
+            ++_counter[0];
+            _index = 0;
+        }
+        return _block[_index++];
+    }
+
+    /// Philox4x32 bijection with 10 rounds.
+    static constexpr Block Philox4x32(Block counter, Key key)
+    {
+        constexpr std::uint32_t M0 = 0xD2511F53;
+        constexpr std::uint32_t M1 = 0xCD9E8D57;
+        constexpr std::uint32_t W0 = 0x9E3779B9;
+        constexpr std::uint32_t W1 = 0xBB67AE85;
+        for(int round = 0; round < 10; ++round) {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(M0) * counter[0];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(M1) * counter[2];
+            counter = Block{
+                static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<std::uint32_t>(p1),
+                static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<std::uint32_t>(p0)};
+            key[0] += W0;
+            key[1] += W1;
+        }
+        return counter;
+    }
+};
@@ -73,6 +73,16 @@ struct GenericAgent {
         return std::visit([](const auto& m) -> const Point& { return m.position; }, model);
     }
 
+    /// Copies everything but the model state from 'other'.
+    void AssignAllButModel(const GenericAgent& other)
+    {
+        id = other.id;
+        journeyId = other.journeyId;
+        stageId = other.stageId;
+        nextTarget = other.nextTarget;
+        finalTarget = other.finalTarget;
+    }
+
     GenericAgent(
         ID id_,
         jps::UniqueID<Journey> journeyId_,
@@ -26,6 +26,12 @@ GeometryBuilder& GeometryBuilder::ExcludeFromAccessibleArea(const std::vector<Po
     return *this;
 }
 
+GeometryBuilder& GeometryBuilder::SetGridCellSize(double cellSize)
+{
+    _gridCellSize = cellSize;
+    return *this;
+}
+
 CollisionGeometry GeometryBuilder::Build()
 {
     const std::vector<Poly> accessibleListInput{
@@ -59,5 +65,5 @@ CollisionGeometry GeometryBuilder::Build()
         accessibleArea = *res.begin();
     }
 
-    return CollisionGeometry(accessibleArea);
+    return CollisionGeometry(accessibleArea, _gridCellSize);
 }
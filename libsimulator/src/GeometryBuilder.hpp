@@ -11,6 +11,7 @@ class GeometryBuilder
 {
     std::vector<Polygon> _accessibleAreas{};
     std::vector<Polygon> _exclusions{};
+    double _gridCellSize{0};
 
 public:
     GeometryBuilder() = default;
@@ -22,5 +23,8 @@ public:
 
     GeometryBuilder& AddAccessibleArea(const std::vector<Point>& lineLoop);
     GeometryBuilder& ExcludeFromAccessibleArea(const std::vector<Point>& lineLoop);
+    /// Sets the edge length of the cells of the geometry grids in meters, 0 chooses the size from
+    /// the density of linesegments.
+    GeometryBuilder& SetGridCellSize(double cellSize);
     CollisionGeometry Build();
 };
@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "GeometryCache.hpp"
+
+#include "CfgCgal.hpp"
+#include "GeometryHash.hpp"
+#include "Logger.hpp"
+#include "Mesh.hpp"
+#include "RoutingEngine.hpp"
+#include "SimulationError.hpp"
+
+#include <CGAL/mark_domain_in_triangulation.h>
+#include <CGAL/number_utils.h>
+#include <fmt/format.h>
+#include <glm/ext/vector_double2.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t MAGIC{0x4f45474a}; // "JGEO" read as little endian
+constexpr uint32_t FORMAT_VERSION{1};
+constexpr uint32_t BYTE_ORDER_MARK{0x01020304};
+
+/// Arrays are read in chunks, so that a damaged length does not allocate arbitrary memory.
+constexpr uint64_t READ_CHUNK_SIZE{1 << 16};
+
+std::vector<const Poly*> ringsOf(const PolyWithHoles& accessibleArea)
+{
+    std::vector<const Poly*> rings{&accessibleArea.outer_boundary()};
+    for(auto hole = accessibleArea.holes_begin(); hole != accessibleArea.holes_end(); ++hole) {
+        rings.push_back(&*hole);
+    }
+    return rings;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeArray(std::ostream& out, const std::vector<T>& values)
+{
+    writeValue(out, static_cast<uint64_t>(values.size()));
+    out.write(
+        reinterpret_cast<const char*>(values.data()),
+        static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return static_cast<bool>(in);
+}
+
+template <typename T>
+bool readArray(std::istream& in, std::vector<T>& values)
+{
+    uint64_t size{};
+    if(!readValue(in, size)) {
+        return false;
+    }
+    values.clear();
+    while(values.size() < size) {
+        const auto offset = values.size();
+        const auto count = std::min<uint64_t>(READ_CHUNK_SIZE, size - offset);
+        values.resize(offset + count);
+        in.read(
+            reinterpret_cast<char*>(values.data() + offset),
+            static_cast<std::streamsize>(count * sizeof(T)));
+        if(!in) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Coordinates of all rings, outer boundary first, as [x0, y0, x1, y1, ...] per ring.
+std::vector<std::vector<double>> coordinatesOf(const PolyWithHoles& accessibleArea)
+{
+    std::vector<std::vector<double>> coordinates{};
+    for(const auto* ring : ringsOf(accessibleArea)) {
+        auto& ringCoordinates = coordinates.emplace_back();
+        ringCoordinates.reserve(2 * ring->size());
+        for(auto v = ring->vertices_begin(); v != ring->vertices_end(); ++v) {
+            ringCoordinates.push_back(CGAL::to_double(v->x()));
+            ringCoordinates.push_back(CGAL::to_double(v->y()));
+        }
+    }
+    return coordinates;
+}
+
+/// Polygons of the mesh as compressed sparse rows, 'offsets' has one entry more than there are
+/// polygons and the entries of polygon i are 'indices[offsets[i]..offsets[i+1]]'.
+struct FlatIndices {
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint64_t> indices{};
+};
+
+std::unique_ptr<Mesh> readMesh(std::istream& in)
+{
+    std::vector<double> coordinates{};
+    FlatIndices polygonVertices{};
+    FlatIndices polygonNeighbors{};
+    if(!readArray(in, coordinates) || !readArray(in, polygonVertices.offsets) ||
+       !readArray(in, polygonVertices.indices) || !readArray(in, polygonNeighbors.offsets) ||
+       !readArray(in, polygonNeighbors.indices)) {
+        return nullptr;
+    }
+    if(coordinates.size() % 2 != 0 || polygonVertices.offsets.empty() ||
+       polygonVertices.offsets.size() != polygonNeighbors.offsets.size()) {
+        return nullptr;
+    }
+
+    const auto vertexCount = coordinates.size() / 2;
+    const auto polygonCount = polygonVertices.offsets.size() - 1;
+    const auto isValid = [](const FlatIndices& flat, uint64_t bound) {
+        return flat.offsets.front() == 0 && flat.offsets.back() == flat.indices.size() &&
+               std::is_sorted(std::begin(flat.offsets), std::end(flat.offsets)) &&
+               std::all_of(std::begin(flat.indices), std::end(flat.indices), [bound](auto i) {
+                   return i < bound || i == Mesh::Polygon::InvalidIndex;
+               });
+    };
+    if(!isValid(polygonVertices, vertexCount) || !isValid(polygonNeighbors, polygonCount)) {
+        return nullptr;
+    }
+
+    std::vector<glm::dvec2> vertices{};
+    vertices.reserve(vertexCount);
+    for(size_t index = 0; index < vertexCount; ++index) {
+        vertices.emplace_back(coordinates[2 * index], coordinates[2 * index + 1]);
+    }
+    std::vector<Mesh::Polygon> polygons(polygonCount);
+    for(size_t index = 0; index < polygonCount; ++index) {
+        polygons[index].vertices.assign(
+            std::begin(polygonVertices.indices) + polygonVertices.offsets[index],
+            std::begin(polygonVertices.indices) + polygonVertices.offsets[index + 1]);
+        polygons[index].neighbors.assign(
+            std::begin(polygonNeighbors.indices) + polygonNeighbors.offsets[index],
+            std::begin(polygonNeighbors.indices) + polygonNeighbors.offsets[index + 1]);
+    }
+    return std::make_unique<Mesh>(std::move(vertices), std::move(polygons));
+}
+
+void writeMesh(std::ostream& out, const Mesh& mesh)
+{
+    std::vector<double> coordinates{};
+    coordinates.reserve(2 * mesh.CountVertices());
+    for(size_t index = 0; index < mesh.CountVertices(); ++index) {
+        const auto v = mesh.Vertex(index);
+        coordinates.push_back(v.x);
+        coordinates.push_back(v.y);
+    }
+    FlatIndices polygonVertices{};
+    FlatIndices polygonNeighbors{};
+    for(size_t index = 0; index < mesh.CountPolygons(); ++index) {
+        const auto& polygon = mesh.Polygons(index);
+        polygonVertices.indices.insert(
+            std::end(polygonVertices.indices),
+            std::begin(polygon.vertices),
+            std::end(polygon.vertices));
+        polygonVertices.offsets.push_back(polygonVertices.indices.size());
+        polygonNeighbors.indices.insert(
+            std::end(polygonNeighbors.indices),
+            std::begin(polygon.neighbors),
+            std::end(polygon.neighbors));
+        polygonNeighbors.offsets.push_back(polygonNeighbors.indices.size());
+    }
+    writeArray(out, coordinates);
+    writeArray(out, polygonVertices.offsets);
+    writeArray(out, polygonVertices.indices);
+    writeArray(out, polygonNeighbors.offsets);
+    writeArray(out, polygonNeighbors.indices);
+}
+} // namespace
+
+void WriteRoutingData(
+    std::ostream& out,
+    const PolyWithHoles& accessibleArea,
+    const RoutingEngine& routingEngine)
+{
+    writeValue(out, MAGIC);
+    writeValue(out, FORMAT_VERSION);
+    writeValue(out, BYTE_ORDER_MARK);
+    writeValue(out, GeometryHash(accessibleArea));
+
+    const auto coordinates = coordinatesOf(accessibleArea);
+    writeValue(out, static_cast<uint64_t>(coordinates.size()));
+    for(const auto& ring : coordinates) {
+        writeArray(out, ring);
+    }
+
+    // CGAL's stream format keeps the constraint flags of the edges, the domain marks of the faces
+    // are recomputed from them when reading.
+    std::ostringstream triangulation{};
+    triangulation.precision(std::numeric_limits<double>::max_digits10);
+    triangulation << routingEngine.Triangulation();
+    const auto text = std::move(triangulation).str();
+    writeArray(out, std::vector<char>(std::begin(text), std::end(text)));
+
+    writeMesh(out, *routingEngine.MeshData());
+}
+
+std::unique_ptr<RoutingEngine>
+ReadRoutingData(std::istream& in, const PolyWithHoles& accessibleArea)
+{
+    uint32_t magic{};
+    uint32_t version{};
+    uint32_t byteOrderMark{};
+    uint64_t hash{};
+    if(!readValue(in, magic) || !readValue(in, version) || !readValue(in, byteOrderMark) ||
+       !readValue(in, hash)) {
+        return nullptr;
+    }
+    if(magic != MAGIC || version != FORMAT_VERSION || byteOrderMark != BYTE_ORDER_MARK ||
+       hash != GeometryHash(accessibleArea)) {
+        return nullptr;
+    }
+
+    // Equal hashes are not enough, the cached data has to be built from exactly this geometry
+    const auto expectedCoordinates = coordinatesOf(accessibleArea);
+    uint64_t ringCount{};
+    if(!readValue(in, ringCount) || ringCount != expectedCoordinates.size()) {
+        return nullptr;
+    }
+    for(const auto& expectedRing : expectedCoordinates) {
+        std::vector<double> ring{};
+        if(!readArray(in, ring) || ring != expectedRing) {
+            return nullptr;
+        }
+    }
+
+    std::vector<char> text{};
+    if(!readArray(in, text)) {
+        return nullptr;
+    }
+    CDT cdt{};
+    std::istringstream triangulation{std::string(std::begin(text), std::end(text))};
+    triangulation >> cdt;
+    if(!triangulation) {
+        return nullptr;
+    }
+    CGAL::mark_domain_in_triangulation(cdt);
+
+    auto mesh = readMesh(in);
+    if(!mesh) {
+        return nullptr;
+    }
+    return std::make_unique<RoutingEngine>(std::move(cdt), std::move(mesh));
+}
+
+GeometryCache::GeometryCache(std::filesystem::path directory) : _directory(std::move(directory))
+{
+}
+
+std::filesystem::path GeometryCache::FileFor(const PolyWithHoles& accessibleArea) const
+{
+    return _directory / fmt::format("{:016x}.jpsgeo", GeometryHash(accessibleArea));
+}
+
+std::unique_ptr<RoutingEngine> GeometryCache::Load(const PolyWithHoles& accessibleArea) const
+{
+    const auto file = FileFor(accessibleArea);
+    std::ifstream in(file, std::ios::binary);
+    if(!in) {
+        return nullptr;
+    }
+    auto routingEngine = ReadRoutingData(in, accessibleArea);
+    if(!routingEngine) {
+        LOG_WARNING("Ignoring invalid geometry cache file {}", file.string());
+    }
+    return routingEngine;
+}
+
+void GeometryCache::Store(const PolyWithHoles& accessibleArea, const RoutingEngine& routingEngine)
+    const
+{
+    std::error_code error{};
+    std::filesystem::create_directories(_directory, error);
+    if(error) {
+        throw SimulationError(
+            "Cannot create geometry cache directory {}: {}", _directory.string(), error.message());
+    }
+
+    const auto file = FileFor(accessibleArea);
+    std::random_device random{};
+    auto temporaryFile = file;
+    temporaryFile += fmt::format(".{:08x}{:08x}.tmp", random(), random());
+    {
+        std::ofstream out(temporaryFile, std::ios::binary | std::ios::trunc);
+        WriteRoutingData(out, accessibleArea, routingEngine);
+        if(!out) {
+            out.close();
+            std::filesystem::remove(temporaryFile, error);
+            throw SimulationError("Cannot write geometry cache file {}", temporaryFile.string());
+        }
+    }
+    // Another simulation may have stored the same geometry in the meantime, both files are equal
+    std::filesystem::rename(temporaryFile, file, error);
+    if(error) {
+        std::filesystem::remove(temporaryFile, error);
+    }
+}
+
+std::unique_ptr<RoutingEngine> GeometryCache::LoadOrBuild(const PolyWithHoles& accessibleArea) const
+{
+    if(auto routingEngine = Load(accessibleArea)) {
+        LOG_DEBUG("Loaded routing data from {}", FileFor(accessibleArea).string());
+        return routingEngine;
+    }
+    auto routingEngine = std::make_unique<RoutingEngine>(accessibleArea);
+    // A read-only or full cache location must not stop a simulation that has its routing data
+    try {
+        Store(accessibleArea, *routingEngine);
+    } catch(const SimulationError& e) {
+        LOG_WARNING("Routing data not cached: {}", e.what());
+    }
+    return routingEngine;
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "CfgCgal.hpp"
+#include "RoutingEngine.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+
+/// Writes the triangulation and navigation mesh of 'routingEngine' in the binary cache format.
+///
+/// The format consists of a header with a magic number, format version, byte order mark and the
+/// geometry hash, followed by the accessible area the data was built for, the triangulation and
+/// the mesh. All numbers are stored as fixed size integers or doubles in native byte order, arrays
+/// are prefixed by their length.
+void WriteRoutingData(
+    std::ostream& out,
+    const PolyWithHoles& accessibleArea,
+    const RoutingEngine& routingEngine);
+
+/// Reads routing data written by 'WriteRoutingData'.
+/// @return the routing engine or nullptr if the data was written for a different accessible area,
+/// by an incompatible version or is damaged
+std::unique_ptr<RoutingEngine>
+ReadRoutingData(std::istream& in, const PolyWithHoles& accessibleArea);
+
+/// Directory of routing data files named after the hash of the accessible area they were built
+/// for. Building the constrained triangulation and navigation mesh of large geometries takes
+/// long, simulations of the same geometry can share the result through the cache.
+///
+/// Files are written to a temporary file first and renamed afterwards, so that simulations
+/// running in parallel never see partially written files.
+class GeometryCache
+{
+    std::filesystem::path _directory;
+
+public:
+    /// @param directory cache directory, created on first store
+    explicit GeometryCache(std::filesystem::path directory);
+
+    /// Path of the cache file for 'accessibleArea'.
+    std::filesystem::path FileFor(const PolyWithHoles& accessibleArea) const;
+
+    /// Loads the routing engine for 'accessibleArea'.
+    /// @return the routing engine or nullptr if the cache has no valid entry
+    std::unique_ptr<RoutingEngine> Load(const PolyWithHoles& accessibleArea) const;
+
+    /// Stores the routing engine built for 'accessibleArea'.
+    /// @throws SimulationError if the file cannot be written
+    void Store(const PolyWithHoles& accessibleArea, const RoutingEngine& routingEngine) const;
+
+    /// Loads the routing engine for 'accessibleArea' or builds and stores it on a cache miss.
+    /// Failing to store the routing engine is logged as a warning and otherwise ignored.
+    std::unique_ptr<RoutingEngine> LoadOrBuild(const PolyWithHoles& accessibleArea) const;
+};
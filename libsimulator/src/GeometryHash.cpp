@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "GeometryHash.hpp"
+
+#include "CfgCgal.hpp"
+
+#include <CGAL/number_utils.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+uint64_t hashValue(uint64_t hash, uint64_t value)
+{
+    // FNV-1a over the bytes of 'value' from least to most significant, independent of byte order
+    constexpr uint64_t prime{0x100000001b3};
+    for(size_t byte = 0; byte < sizeof(value); ++byte) {
+        hash ^= (value >> (8 * byte)) & 0xff;
+        hash *= prime;
+    }
+    return hash;
+}
+
+uint64_t hashRing(uint64_t hash, const Poly& ring)
+{
+    hash = hashValue(hash, 2 * ring.size());
+    for(auto v = ring.vertices_begin(); v != ring.vertices_end(); ++v) {
+        hash = hashValue(hash, std::bit_cast<uint64_t>(CGAL::to_double(v->x())));
+        hash = hashValue(hash, std::bit_cast<uint64_t>(CGAL::to_double(v->y())));
+    }
+    return hash;
+}
+} // namespace
+
+uint64_t GeometryHash(const PolyWithHoles& accessibleArea)
+{
+    uint64_t hash{0xcbf29ce484222325};
+    hash = hashValue(hash, 1 + accessibleArea.number_of_holes());
+    hash = hashRing(hash, accessibleArea.outer_boundary());
+    for(auto hole = accessibleArea.holes_begin(); hole != accessibleArea.holes_end(); ++hole) {
+        hash = hashRing(hash, *hole);
+    }
+    return hash;
+}
@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "CfgCgal.hpp"
+
+#include <cstdint>
+
+/// Hash of the coordinates of an accessible area that does not change between runs or platforms.
+uint64_t GeometryHash(const PolyWithHoles& accessibleArea);
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "LineSegmentBlock.hpp"
+
+#include "LineSegment.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JPS_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JPS_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+/// Raw view on the arrays of a block, the kernels write to 'result' starting at 'begin'.
+struct Kernel {
+    const double* x1;
+    const double* y1;
+    const double* x2;
+    const double* y2;
+    const double* tx;
+    const double* ty;
+    const double* lengthSquare;
+    double* cx;
+    double* cy;
+    double* distance;
+};
+
+// All kernels evaluate the same operations in the same order as 'LineSegment::ShortestPoint'
+// followed by 'Point::Norm', without fused multiply add, so that results are bit identical.
+
+void closestPointsScalar(const Kernel& k, size_t begin, size_t end, double px, double py)
+{
+    for(size_t i = begin; i < end; ++i) {
+        double cx{};
+        double cy{};
+        if(k.x1[i] == k.x2[i] && k.y1[i] == k.y2[i]) {
+            cx = k.x1[i];
+            cy = k.y1[i];
+        } else {
+            const double lambda =
+                ((px - k.x2[i]) * k.tx[i] + (py - k.y2[i]) * k.ty[i]) / k.lengthSquare[i];
+            if(lambda < 0) {
+                cx = k.x2[i];
+                cy = k.y2[i];
+            } else if(lambda > 1) {
+                cx = k.x1[i];
+                cy = k.y1[i];
+            } else {
+                cx = k.x2[i] + k.tx[i] * lambda;
+                cy = k.y2[i] + k.ty[i] * lambda;
+            }
+        }
+        const double dx = cx - px;
+        const double dy = cy - py;
+        k.cx[i] = cx;
+        k.cy[i] = cy;
+        k.distance[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+#ifdef JPS_HAS_SSE2
+/// Processes two linesegments at a time, returns the first index that was not processed.
+size_t closestPointsSse2(const Kernel& k, size_t end, double px, double py)
+{
+    const auto select = [](__m128d mask, __m128d a, __m128d b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    };
+    const auto vpx = _mm_set1_pd(px);
+    const auto vpy = _mm_set1_pd(py);
+    const auto zero = _mm_setzero_pd();
+    const auto one = _mm_set1_pd(1.);
+    size_t i = 0;
+    for(; i + 2 <= end; i += 2) {
+        const auto x1 = _mm_loadu_pd(k.x1 + i);
+        const auto y1 = _mm_loadu_pd(k.y1 + i);
+        const auto x2 = _mm_loadu_pd(k.x2 + i);
+        const auto y2 = _mm_loadu_pd(k.y2 + i);
+        const auto tx = _mm_loadu_pd(k.tx + i);
+        const auto ty = _mm_loadu_pd(k.ty + i);
+        const auto lambda = _mm_div_pd(
+            _mm_add_pd(_mm_mul_pd(_mm_sub_pd(vpx, x2), tx), _mm_mul_pd(_mm_sub_pd(vpy, y2), ty)),
+            _mm_loadu_pd(k.lengthSquare + i));
+        const auto below = _mm_cmplt_pd(lambda, zero);
+        const auto above = _mm_cmpgt_pd(lambda, one);
+        const auto degenerate = _mm_and_pd(_mm_cmpeq_pd(x1, x2), _mm_cmpeq_pd(y1, y2));
+        const auto first = _mm_or_pd(degenerate, above);
+        auto cx = _mm_add_pd(x2, _mm_mul_pd(tx, lambda));
+        auto cy = _mm_add_pd(y2, _mm_mul_pd(ty, lambda));
+        cx = select(below, x2, cx);
+        cy = select(below, y2, cy);
+        cx = select(first, x1, cx);
+        cy = select(first, y1, cy);
+        const auto dx = _mm_sub_pd(cx, vpx);
+        const auto dy = _mm_sub_pd(cy, vpy);
+        _mm_storeu_pd(k.cx + i, cx);
+        _mm_storeu_pd(k.cy + i, cy);
+        _mm_storeu_pd(
+            k.distance + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    return i;
+}
+#endif
+
+#ifdef JPS_HAS_AVX2
+/// Processes four linesegments at a time, returns the first index that was not processed.
+__attribute__((target("avx2"))) size_t
+closestPointsAvx2(const Kernel& k, size_t end, double px, double py)
+{
+    const auto vpx = _mm256_set1_pd(px);
+    const auto vpy = _mm256_set1_pd(py);
+    const auto zero = _mm256_setzero_pd();
+    const auto one = _mm256_set1_pd(1.);
+    size_t i = 0;
+    for(; i + 4 <= end; i += 4) {
+        const auto x1 = _mm256_loadu_pd(k.x1 + i);
+        const auto y1 = _mm256_loadu_pd(k.y1 + i);
+        const auto x2 = _mm256_loadu_pd(k.x2 + i);
+        const auto y2 = _mm256_loadu_pd(k.y2 + i);
+        const auto tx = _mm256_loadu_pd(k.tx + i);
+        const auto ty = _mm256_loadu_pd(k.ty + i);
+        const auto lambda = _mm256_div_pd(
+            _mm256_add_pd(
+                _mm256_mul_pd(_mm256_sub_pd(vpx, x2), tx),
+                _mm256_mul_pd(_mm256_sub_pd(vpy, y2), ty)),
+            _mm256_loadu_pd(k.lengthSquare + i));
+        const auto below = _mm256_cmp_pd(lambda, zero, _CMP_LT_OQ);
+        const auto above = _mm256_cmp_pd(lambda, one, _CMP_GT_OQ);
+        const auto degenerate = _mm256_and_pd(
+            _mm256_cmp_pd(x1, x2, _CMP_EQ_OQ), _mm256_cmp_pd(y1, y2, _CMP_EQ_OQ));
+        const auto first = _mm256_or_pd(degenerate, above);
+        auto cx = _mm256_add_pd(x2, _mm256_mul_pd(tx, lambda));
+        auto cy = _mm256_add_pd(y2, _mm256_mul_pd(ty, lambda));
+        cx = _mm256_blendv_pd(cx, x2, below);
+        cy = _mm256_blendv_pd(cy, y2, below);
+        cx = _mm256_blendv_pd(cx, x1, first);
+        cy = _mm256_blendv_pd(cy, y1, first);
+        const auto dx = _mm256_sub_pd(cx, vpx);
+        const auto dy = _mm256_sub_pd(cy, vpy);
+        _mm256_storeu_pd(k.cx + i, cx);
+        _mm256_storeu_pd(k.cy + i, cy);
+        _mm256_storeu_pd(
+            k.distance + i,
+            _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    return i;
+}
+#endif
+} // namespace
+
+LineSegmentBlock::LineSegmentBlock(const std::vector<LineSegment>& segments)
+{
+    for(auto* v : {&_x1, &_y1, &_x2, &_y2, &_tx, &_ty, &_lengthSquare}) {
+        v->reserve(segments.size());
+    }
+    for(const auto& ls : segments) {
+        const auto t = ls.p1 - ls.p2;
+        _x1.push_back(ls.p1.x);
+        _y1.push_back(ls.p1.y);
+        _x2.push_back(ls.p2.x);
+        _y2.push_back(ls.p2.y);
+        _tx.push_back(t.x);
+        _ty.push_back(t.y);
+        _lengthSquare.push_back(t.ScalarProduct(t));
+    }
+}
+
+void LineSegmentBlock::ClosestPointsTo(Point p, ClosestPoints& result) const
+{
+    static const auto instructionSet = SupportedInstructionSet();
+    ClosestPointsTo(p, result, instructionSet);
+}
+
+void LineSegmentBlock::ClosestPointsTo(
+    Point p,
+    ClosestPoints& result,
+    InstructionSet instructionSet) const
+{
+    if(!IsSupported(instructionSet)) {
+        throw SimulationError(
+            "Instruction set {} is not supported by this CPU", static_cast<int>(instructionSet));
+    }
+
+    result.x.resize(Size());
+    result.y.resize(Size());
+    result.distance.resize(Size());
+    const Kernel k{
+        _x1.data(),
+        _y1.data(),
+        _x2.data(),
+        _y2.data(),
+        _tx.data(),
+        _ty.data(),
+        _lengthSquare.data(),
+        result.x.data(),
+        result.y.data(),
+        result.distance.data()};
+
+    // Vector kernels leave the remainder that does not fill a whole register to the scalar kernel
+    size_t done = 0;
+    switch(instructionSet) {
+        case InstructionSet::Avx2:
+#ifdef JPS_HAS_AVX2
+            done = closestPointsAvx2(k, Size(), p.x, p.y);
+#endif
+            break;
+        case InstructionSet::Sse2:
+#ifdef JPS_HAS_SSE2
+            done = closestPointsSse2(k, Size(), p.x, p.y);
+#endif
+            break;
+        case InstructionSet::Scalar:
+            break;
+    }
+    closestPointsScalar(k, done, Size(), p.x, p.y);
+}
+
+LineSegmentBlock::InstructionSet LineSegmentBlock::SupportedInstructionSet()
+{
+    for(const auto instructionSet : {InstructionSet::Avx2, InstructionSet::Sse2}) {
+        if(IsSupported(instructionSet)) {
+            return instructionSet;
+        }
+    }
+    return InstructionSet::Scalar;
+}
+
+bool LineSegmentBlock::IsSupported(InstructionSet instructionSet)
+{
+    switch(instructionSet) {
+        case InstructionSet::Avx2:
+#ifdef JPS_HAS_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case InstructionSet::Sse2:
+#ifdef JPS_HAS_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case InstructionSet::Scalar:
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "LineSegment.hpp"
+#include "Point.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Closest points of a reference point on all linesegments of a 'LineSegmentBlock'.
+struct ClosestPoints {
+    std::vector<double> x{};
+    std::vector<double> y{};
+    /// Distance of the reference point to the closest point.
+    std::vector<double> distance{};
+
+    size_t Size() const { return distance.size(); }
+
+    Point At(size_t index) const { return {x[index], y[index]}; }
+};
+
+/// Linesegments stored as structure of arrays, so that the closest points of one reference point
+/// on all linesegments can be computed with SIMD instructions.
+///
+/// The instruction set is chosen at runtime, AVX2 and SSE2 on x86-64 with a scalar fallback on all
+/// other platforms. All variants produce results bit identical to 'LineSegment::ShortestPoint'.
+class LineSegmentBlock
+{
+public:
+    enum class InstructionSet { Scalar, Sse2, Avx2 };
+
+private:
+    std::vector<double> _x1{};
+    std::vector<double> _y1{};
+    std::vector<double> _x2{};
+    std::vector<double> _y2{};
+    /// p1 - p2
+    std::vector<double> _tx{};
+    std::vector<double> _ty{};
+    /// Squared length of (p1 - p2)
+    std::vector<double> _lengthSquare{};
+
+public:
+    LineSegmentBlock() = default;
+    explicit LineSegmentBlock(const std::vector<LineSegment>& segments);
+
+    size_t Size() const { return _x1.size(); }
+
+    /// Computes the closest point of 'p' on every linesegment of the block, in the order of the
+    /// block, using the best instruction set supported by the CPU.
+    /// @param p reference point
+    /// @param result is resized to 'Size()', buffers are reused between calls
+    void ClosestPointsTo(Point p, ClosestPoints& result) const;
+
+    /// Same as above with an explicitly chosen instruction set.
+    /// @throws SimulationError if 'instructionSet' is not supported by the CPU
+    void ClosestPointsTo(Point p, ClosestPoints& result, InstructionSet instructionSet) const;
+
+    /// Best instruction set supported by the CPU, determined once.
+    static InstructionSet SupportedInstructionSet();
+
+    /// Checks if the CPU can execute 'instructionSet'.
+    static bool IsSupported(InstructionSet instructionSet);
+};
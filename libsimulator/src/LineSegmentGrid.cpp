@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "LineSegmentGrid.hpp"
+
+#include "LineSegment.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+LineSegmentGrid::LineSegmentGrid(const std::vector<LineSegment>& segments, double cellSize)
+    : _cellSize(cellSize)
+{
+    if(segments.empty()) {
+        return;
+    }
+
+    auto lastColumn = Column(segments.front().p1.x);
+    auto lastRow = Row(segments.front().p1.y);
+    _firstColumn = lastColumn;
+    _firstRow = lastRow;
+    for(const auto& ls : segments) {
+        for(const auto& p : {ls.p1, ls.p2}) {
+            _firstColumn = std::min(_firstColumn, Column(p.x));
+            _firstRow = std::min(_firstRow, Row(p.y));
+            lastColumn = std::max(lastColumn, Column(p.x));
+            lastRow = std::max(lastRow, Row(p.y));
+        }
+    }
+    _columns = static_cast<size_t>(lastColumn - _firstColumn + 1);
+    _rows = static_cast<size_t>(lastRow - _firstRow + 1);
+
+    const auto cellIndex = [this](int64_t column, int64_t row) {
+        return static_cast<size_t>(row - _firstRow) * _columns +
+               static_cast<size_t>(column - _firstColumn);
+    };
+
+    // Count the linesegments per cell first, so that all lists can be placed in one allocation
+    _start.assign(CellCount() + 1, 0);
+    for(const auto& ls : segments) {
+        ForEachCellAlong(ls, [this, &cellIndex](int64_t column, int64_t row) {
+            ++_start[cellIndex(column, row) + 1];
+            return false;
+        });
+    }
+    std::partial_sum(std::begin(_start), std::end(_start), std::begin(_start));
+
+    _segments.resize(_start.back());
+    std::vector<uint32_t> next(std::begin(_start), std::end(_start) - 1);
+    for(size_t index = 0; index < segments.size(); ++index) {
+        ForEachCellAlong(
+            segments[index], [this, &cellIndex, &next, index](int64_t column, int64_t row) {
+                _segments[next[cellIndex(column, row)]++] = static_cast<uint32_t>(index);
+                return false;
+            });
+    }
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "IteratorPair.hpp"
+#include "LineSegment.hpp"
+#include "Point.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+/// Uniform grid of square cells over a set of linesegments.
+///
+/// Cells are addressed by integer column and row, cell (column, row) covers the interval
+/// [column * cellSize, (column + 1) * cellSize) x [row * cellSize, (row + 1) * cellSize).
+/// Every cell lists the indices of all linesegments touching it in ascending order. The lists of
+/// all cells are stored back to back in a single vector.
+class LineSegmentGrid
+{
+public:
+    using SegmentRange = IteratorPair<std::vector<uint32_t>::const_iterator>;
+
+private:
+    double _cellSize{1};
+    int64_t _firstColumn{0};
+    int64_t _firstRow{0};
+    size_t _columns{0};
+    size_t _rows{0};
+    /// Cell 'i' lists its linesegments in '_segments[_start[i], _start[i + 1])'
+    std::vector<uint32_t> _start{0};
+    std::vector<uint32_t> _segments{};
+
+public:
+    LineSegmentGrid() = default;
+    /// Creates a grid covering all 'segments'.
+    /// @param segments linesegments to insert, they are referred to by their index
+    /// @param cellSize edge length of a cell
+    LineSegmentGrid(const std::vector<LineSegment>& segments, double cellSize);
+
+    double CellSize() const { return _cellSize; }
+
+    /// Number of cells in the grid.
+    size_t CellCount() const { return _columns * _rows; }
+
+    int64_t Column(double x) const { return static_cast<int64_t>(std::floor(x / _cellSize)); }
+
+    int64_t Row(double y) const { return static_cast<int64_t>(std::floor(y / _cellSize)); }
+
+    /// Indices of all linesegments touching a cell, empty for cells outside of the grid.
+    SegmentRange SegmentsInCell(int64_t column, int64_t row) const
+    {
+        if(column < _firstColumn || row < _firstRow ||
+           column >= _firstColumn + static_cast<int64_t>(_columns) ||
+           row >= _firstRow + static_cast<int64_t>(_rows)) {
+            return {_segments.cend(), _segments.cend()};
+        }
+        const auto cell = static_cast<size_t>(row - _firstRow) * _columns +
+                          static_cast<size_t>(column - _firstColumn);
+        return {_segments.cbegin() + _start[cell], _segments.cbegin() + _start[cell + 1]};
+    }
+
+    /// Visits all cells touched by 'ls' in order from 'ls.p1' to 'ls.p2'.
+    /// @param fn called with column and row of each cell, returning true stops the walk
+    /// @return true if 'fn' stopped the walk
+    template <typename Fn>
+    bool ForEachCellAlong(const LineSegment& ls, Fn&& fn) const
+    {
+        return ForEachCellAlong(ls, _cellSize, fn);
+    }
+
+    /// Visits all cells of size 'cellSize' touched by 'ls' in order from 'ls.p1' to 'ls.p2'.
+    ///
+    /// Walks the cells as described by Amanatides and Woo, "A Fast Voxel Traversal Algorithm for
+    /// Ray Tracing" (1987). A cell is touched if it contains any point of 'ls', so a linesegment
+    /// passing exactly through a cell corner also visits the cell the corner belongs to.
+    /// @param fn called with column and row of each cell, returning true stops the walk
+    /// @return true if 'fn' stopped the walk
+    template <typename Fn>
+    static bool ForEachCellAlong(const LineSegment& ls, double cellSize, Fn&& fn)
+    {
+        auto column = static_cast<int64_t>(std::floor(ls.p1.x / cellSize));
+        auto row = static_cast<int64_t>(std::floor(ls.p1.y / cellSize));
+        if(fn(column, row)) {
+            return true;
+        }
+
+        const auto lastColumn = static_cast<int64_t>(std::floor(ls.p2.x / cellSize));
+        const auto lastRow = static_cast<int64_t>(std::floor(ls.p2.y / cellSize));
+        auto remainingColumns = std::abs(lastColumn - column);
+        auto remainingRows = std::abs(lastRow - row);
+        const int64_t stepColumn = lastColumn > column ? 1 : -1;
+        const int64_t stepRow = lastRow > row ? 1 : -1;
+
+        // Parameters along 'ls' at which the next column / row boundary is crossed, axes without
+        // remaining boundaries are never crossed.
+        constexpr auto never = std::numeric_limits<double>::infinity();
+        const auto direction = ls.p2 - ls.p1;
+        const auto tDeltaX = remainingColumns > 0 ? cellSize / std::abs(direction.x) : never;
+        const auto tDeltaY = remainingRows > 0 ? cellSize / std::abs(direction.y) : never;
+        auto tMaxX = remainingColumns > 0 ?
+                         ((column + (stepColumn > 0)) * cellSize - ls.p1.x) / direction.x :
+                         never;
+        auto tMaxY =
+            remainingRows > 0 ? ((row + (stepRow > 0)) * cellSize - ls.p1.y) / direction.y : never;
+
+        while(remainingColumns > 0 || remainingRows > 0) {
+            if(tMaxX < tMaxY) {
+                column += stepColumn;
+                tMaxX = --remainingColumns > 0 ? tMaxX + tDeltaX : never;
+            } else if(tMaxY < tMaxX) {
+                row += stepRow;
+                tMaxY = --remainingRows > 0 ? tMaxY + tDeltaY : never;
+            } else {
+                // Passing exactly through a corner, which belongs to the cell in positive
+                // direction of both axes.
+                const auto cornerColumn = column + (stepColumn > 0);
+                const auto cornerRow = row + (stepRow > 0);
+                const auto isCurrent = cornerColumn == column && cornerRow == row;
+                column += stepColumn;
+                row += stepRow;
+                const auto isNext = cornerColumn == column && cornerRow == row;
+                if(!isCurrent && !isNext && fn(cornerColumn, cornerRow)) {
+                    return true;
+                }
+                tMaxX = --remainingColumns > 0 ? tMaxX + tDeltaX : never;
+                tMaxY = --remainingRows > 0 ? tMaxY + tDeltaY : never;
+            }
+            if(fn(column, row)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "Logger.hpp"
 
+#include <mutex>
 #include <string>
 
 namespace Logging
@@ -14,16 +15,19 @@ Logger& Logger::Instance()
 
 void Logger::SetDebugCallback(LogCallback&& cb)
 {
+    const std::lock_guard lock(mutex);
     debug_msg_cb = cb;
 }
 
 void Logger::ClearDebugCallback()
 {
+    const std::lock_guard lock(mutex);
     debug_msg_cb = {};
 }
 
 void Logger::LogDebugMessage(const std::string& msg)
 {
+    const std::lock_guard lock(mutex);
     if(debug_msg_cb) {
         debug_msg_cb(msg);
     }
@@ -31,16 +35,19 @@ void Logger::LogDebugMessage(const std::string& msg)
 
 void Logger::SetInfoCallback(LogCallback&& cb)
 {
+    const std::lock_guard lock(mutex);
     info_msg_cb = cb;
 }
 
 void Logger::ClearInfoCallback()
 {
+    const std::lock_guard lock(mutex);
     info_msg_cb = {};
 }
 
 void Logger::LogInfoMessage(const std::string& msg)
 {
+    const std::lock_guard lock(mutex);
     if(info_msg_cb) {
         info_msg_cb(msg);
     }
@@ -48,16 +55,19 @@ void Logger::LogInfoMessage(const std::string& msg)
 
 void Logger::SetWarningCallback(LogCallback&& cb)
 {
+    const std::lock_guard lock(mutex);
     warning_msg_cb = cb;
 }
 
 void Logger::ClearWarningCallback()
 {
+    const std::lock_guard lock(mutex);
     warning_msg_cb = {};
 }
 
 void Logger::LogWarningMessage(const std::string& msg)
 {
+    const std::lock_guard lock(mutex);
     if(warning_msg_cb) {
         warning_msg_cb(msg);
     }
@@ -65,16 +75,19 @@ void Logger::LogWarningMessage(const std::string& msg)
 
 void Logger::SetErrorCallback(LogCallback&& cb)
 {
+    const std::lock_guard lock(mutex);
     error_msg_cb = cb;
 }
 
 void Logger::ClearErrorCallback()
 {
+    const std::lock_guard lock(mutex);
     error_msg_cb = {};
 }
 
 void Logger::LogErrorMessage(const std::string& msg)
 {
+    const std::lock_guard lock(mutex);
     if(error_msg_cb) {
         error_msg_cb(msg);
     }
@@ -4,6 +4,7 @@
 #include <fmt/format.h>
 
 #include <functional>
+#include <mutex>
 #include <string>
 
 namespace Logging
@@ -15,6 +16,9 @@ public:
     using LogCallback = std::function<void(const std::string& msg)>;
 
 private:
+    /// Messages are logged from the worker threads of the operational step, callbacks are
+    /// called one at a time.
+    std::mutex mutex{};
     LogCallback debug_msg_cb{};
     LogCallback info_msg_cb{};
     LogCallback warning_msg_cb{};
@@ -17,12 +17,14 @@
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <numbers>
 #include <optional>
 #include <queue>
 #include <set>
 #include <sstream>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 Mesh::Mesh(const CDT& cdt)
@@ -86,6 +88,12 @@ Mesh::Mesh(const CDT& cdt)
     updateBoundingBoxes();
 };
 
+Mesh::Mesh(std::vector<glm::dvec2> vertices_, std::vector<Polygon> polygons_)
+    : vertices(std::move(vertices_)), polygons(std::move(polygons_))
+{
+    updateBoundingBoxes();
+}
+
 void Mesh::MergeGreedy()
 {
     mergeDeadEnds();
@@ -168,7 +176,7 @@ double Mesh::polygonArea(const std::vector<size_t> indices) const
         const auto& current_vertex = vertices[indices[index]];
         const auto& next_vertex = vertices[indices[next(index)]];
 
-        area += (current_vertex.x * next_vertex.y) - (current_vertex.y - next_vertex.x);
+        area += (current_vertex.x * next_vertex.y) - (current_vertex.y * next_vertex.x);
     }
     area = std::abs(area) / 2.0;
     return area;
@@ -249,7 +257,7 @@ void Mesh::smartMerge(bool keep_deadends = true)
         const auto node = polygonQueue.top();
         polygonQueue.pop();
 
-        if(abs(node.area - bestMerge[node.source]) > 1e-8) {
+        if(std::abs(node.area - bestMerge[node.source]) > 1e-8) {
             // Not the right node.
             continue;
         }
@@ -339,6 +347,7 @@ bool Mesh::polygonIsConvex(const std::vector<size_t>& indices) const
         return (index + 1) % count;
     };
 
+    double turn{};
     for(size_t index = 0; index < indices.size(); ++index) {
         const auto& current_vertex = vertices[indices[index]];
         const auto& prev_vertex = vertices[indices[prev(index)]];
@@ -352,8 +361,16 @@ bool Mesh::polygonIsConvex(const std::vector<size_t>& indices) const
             // This indicates CW winding between consecutive segments
             return false;
         }
+        const auto dp = glm::dot(segment_a, segment_b);
+        if(cp.z == 0.0 && dp < 0.0) {
+            // Consecutive segments in opposite directions, e.g. after merging polygons that share
+            // more than one edge
+            return false;
+        }
+        turn += std::atan2(cp.z, dp);
     }
-    return true;
+    // Polygons winding around a hole only turn left as well but turn more than once
+    return turn < 2.0 * std::numbers::pi + 1e-6;
 }
 
 std::tuple<std::vector<size_t>, std::vector<size_t>>
@@ -526,12 +543,82 @@ void Mesh::updateBoundingBoxes()
 
             return AABB{{xMin, yMin}, {xMax, yMax}};
         });
+    buildPolygonGrid();
+}
+
+void Mesh::buildPolygonGrid()
+{
+    polygonGridColumns = 0;
+    polygonGridRows = 0;
+    polygonGridStart.assign(1, 0);
+    polygonGridEntries.clear();
+    if(boundingBoxes.empty()) {
+        return;
+    }
+
+    glm::dvec2 min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    glm::dvec2 max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for(const auto& box : boundingBoxes) {
+        min = {std::min(min.x, box.xmin), std::min(min.y, box.ymin)};
+        max = {std::max(max.x, box.xmax), std::max(max.y, box.ymax)};
+    }
+
+    // Roughly one cell per polygon, so a cell overlaps only a few bounding boxes
+    const auto extent = max - min;
+    polygonGridOrigin = min;
+    polygonGridCellSize =
+        std::sqrt(extent.x * extent.y / static_cast<double>(boundingBoxes.size()));
+    if(!(polygonGridCellSize > 0.0)) {
+        polygonGridCellSize = std::max({extent.x, extent.y, 1.0});
+    }
+    polygonGridColumns = static_cast<size_t>(extent.x / polygonGridCellSize) + 1;
+    polygonGridRows = static_cast<size_t>(extent.y / polygonGridCellSize) + 1;
+
+    const auto column = [this](double x) {
+        return static_cast<size_t>((x - polygonGridOrigin.x) / polygonGridCellSize);
+    };
+    const auto row = [this](double y) {
+        return static_cast<size_t>((y - polygonGridOrigin.y) / polygonGridCellSize);
+    };
+    // Count the polygons per cell first, then fill the cells in polygon order
+    const auto forEachCell = [&](const AABB& box, auto&& fn) {
+        for(auto r = row(box.ymin); r <= row(box.ymax); ++r) {
+            for(auto c = column(box.xmin); c <= column(box.xmax); ++c) {
+                fn(r * polygonGridColumns + c);
+            }
+        }
+    };
+    polygonGridStart.assign(polygonGridColumns * polygonGridRows + 1, 0);
+    for(const auto& box : boundingBoxes) {
+        forEachCell(box, [this](size_t cell) { ++polygonGridStart[cell + 1]; });
+    }
+    for(size_t cell = 1; cell < polygonGridStart.size(); ++cell) {
+        polygonGridStart[cell] += polygonGridStart[cell - 1];
+    }
+    polygonGridEntries.resize(polygonGridStart.back());
+    std::vector<uint32_t> fill(std::begin(polygonGridStart), std::end(polygonGridStart) - 1);
+    for(size_t index = 0; index < boundingBoxes.size(); ++index) {
+        forEachCell(boundingBoxes[index], [this, &fill, index](size_t cell) {
+            polygonGridEntries[fill[cell]++] = static_cast<uint32_t>(index);
+        });
+    }
 }
 
 size_t Mesh::FindContainingPolygon(const glm::dvec2& p) const
 {
-    for(size_t index = 0; index < polygons.size(); ++index) {
-        if(boundingBoxes[index].Inside({p.x, p.y}) && TriangleContains(index, p)) {
+    if(!(p.x >= polygonGridOrigin.x && p.y >= polygonGridOrigin.y)) {
+        return Polygon::InvalidIndex;
+    }
+    const auto column = static_cast<size_t>((p.x - polygonGridOrigin.x) / polygonGridCellSize);
+    const auto row = static_cast<size_t>((p.y - polygonGridOrigin.y) / polygonGridCellSize);
+    if(column >= polygonGridColumns || row >= polygonGridRows) {
+        return Polygon::InvalidIndex;
+    }
+
+    const auto cell = row * polygonGridColumns + column;
+    for(auto entry = polygonGridStart[cell]; entry < polygonGridStart[cell + 1]; ++entry) {
+        const size_t index = polygonGridEntries[entry];
+        if(boundingBoxes[index].Inside({p.x, p.y}) && PolygonContains(index, p)) {
             return index;
         }
     }
@@ -676,3 +763,17 @@ bool Mesh::TriangleContains(const size_t polygonIndex, glm::dvec2 p) const
     }
     return true;
 }
+
+bool Mesh::PolygonContains(const size_t polygonIndex, glm::dvec2 p) const
+{
+    const auto& poly = polygons[polygonIndex];
+    const auto count = poly.vertices.size();
+    for(size_t index = 0; index < count; ++index) {
+        const auto a = vertices[poly.vertices[index]];
+        const auto b = vertices[poly.vertices[(index + 1) % count]];
+        if(cross2D(p - a, b - a) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -32,9 +32,20 @@ private:
     /// All convex polygons in this Mesh in CCW orientation.
     std::vector<Polygon> polygons{};
     std::vector<AABB> boundingBoxes{};
+    /// Uniform grid over the bounding boxes of all polygons. Cell 'i' lists the polygons whose
+    /// bounding box overlaps it in ascending order in
+    /// 'polygonGridEntries[polygonGridStart[i], polygonGridStart[i + 1])'.
+    glm::dvec2 polygonGridOrigin{};
+    double polygonGridCellSize{1.0};
+    size_t polygonGridColumns{};
+    size_t polygonGridRows{};
+    std::vector<uint32_t> polygonGridStart{0};
+    std::vector<uint32_t> polygonGridEntries{};
 
 public:
     explicit Mesh(const CDT& cdt);
+    /// Creates a mesh from previously extracted vertices and polygons, e.g. read from a cache.
+    Mesh(std::vector<glm::dvec2> vertices, std::vector<Polygon> polygons);
     ~Mesh() = default;
     Mesh(const Mesh& other) = default;
     Mesh& operator=(const Mesh& other) = default;
@@ -44,6 +55,8 @@ public:
     std::vector<glm::vec2> FVertices() const;
     std::vector<uint16_t> TriangleIndices() const;
     std::vector<uint16_t> SegmentIndices() const;
+    /// Index of the polygon containing 'p' or 'Polygon::InvalidIndex' if 'p' is outside of the
+    /// mesh. Only polygons listed in the grid cell of 'p' are tested.
     size_t FindContainingPolygon(const glm::dvec2& p) const;
     glm::dvec2 Vertex(size_t index) const;
     size_t CountVertices() const { return vertices.size(); }
@@ -52,6 +65,8 @@ public:
     const Mesh::Polygon& Polygons(size_t index) const { return polygons.at(index); }
     const AABB& AxisAlignedBoundingBox(size_t index) const { return boundingBoxes.at(index); }
     bool TriangleContains(const size_t, glm::dvec2 p) const;
+    /// Checks if 'p' is inside or on the boundary of a convex polygon.
+    bool PolygonContains(const size_t, glm::dvec2 p) const;
 
 private:
     void mergeDeadEnds();
@@ -66,4 +81,5 @@ private:
     double polygonArea(const std::vector<size_t> indices) const;
     void trimEmptyPolygons();
     void updateBoundingBoxes();
+    void buildPolygonGrid();
 };
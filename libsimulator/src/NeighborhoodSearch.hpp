@@ -1,16 +1,19 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
+#include "AABB.hpp"
 #include "GenericAgent.hpp"
-#include "HashCombine.hpp"
 #include "Point.hpp"
+#include "SimulationError.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <iterator>
+#include <numeric>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 template <typename T>
@@ -37,104 +40,461 @@ const T* as_ptr(const T& t)
     return &t;
 }
 
-struct Grid2DIndex {
-    std::int32_t idx;
-    std::int32_t idy;
+template <typename Value>
+class NeighborhoodSearch
+{
+    /// Upper bound for the number of grid cells, larger areas are covered with larger cells.
+    static constexpr double MaxCellCount = 1 << 22;
 
-    bool operator<(const Grid2DIndex& other) const
+    double _minCellSize;
+    double _cellSize;
+    double _inverseCellSize;
+    bool _hasBounds{false};
+    Point _origin{};
+    int32_t _columns{1};
+    int32_t _rows{1};
+    /// Dense CSR grid: the items of cell 'c' are _items[_cellStart[c]] up to
+    /// _items[_cellStart[c + 1]] (exclusive). Cells are stored column by column, so the cells of
+    /// a query intersecting one column form a single contiguous range of _items.
+    std::vector<uint32_t> _cellStart{0, 0};
+    std::vector<const Value*> _items{};
+    /// Position of each item of _items, stored contiguously so that the distance test of a
+    /// query does not have to touch the agents themselves.
+    std::vector<Point> _positions{};
+    /// Container index of the item stored at each position of _items.
+    std::vector<uint32_t> _itemIndices{};
+    /// Cell and position in _items for each container index, i.e. the inverse of _itemIndices.
+    std::vector<uint32_t> _itemCells{};
+    std::vector<uint32_t> _itemSlots{};
+    /// Scratch buffers of UpdatePositions(): container index, old cell, new cell and the cells
+    /// passed by relocated items.
+    std::vector<std::array<uint32_t, 3>> _moved{};
+    std::vector<uint32_t> _passedCells{};
+    /// Items added with AddAgent() since the last Update(), keyed by cell index.
+    std::unordered_map<uint32_t, std::vector<const Value*>> _added{};
+
+    /// Verlet neighbor lists, see EnableNeighborLists(). Items are numbered by their position in
+    /// _items when the lists were built ("list slot"), so spatially close items have close
+    /// numbers and the entries of a list point into a few small ranges of _listPositions.
+    /// The list of list slot 's' holds the list slots _listItems[_listStart[s]] up to
+    /// _listItems[_listStart[s + 1]] (exclusive), i.e. all items that were within _listRadius of
+    /// _listOrigins[s] when the lists were built.
+    bool _listsEnabled{false};
+    bool _listsValid{false};
+    double _listCutOffRadius{0};
+    double _listRadius{0};
+    double _maxDisplacementSquared{0};
+    std::vector<uint32_t> _listStart{};
+    std::vector<uint32_t> _listItems{};
+    std::vector<Point> _listOrigins{};
+    /// Current position and address of each item by list slot.
+    struct ListedItem {
+        Point position;
+        const Value* item;
+    };
+    std::vector<ListedItem> _listed{};
+    /// List slot by container index.
+    std::vector<uint32_t> _listSlots{};
+
+private:
+    /// Truncating after clamping to [0, count - 1] is the same as flooring, but cheaper.
+    static int32_t clampToGrid(double cell, int32_t count)
     {
-        return idx < other.idx || (idx == other.idx && idy < other.idy);
+        return static_cast<int32_t>(std::clamp(cell, 0.0, static_cast<double>(count - 1)));
     }
 
-    bool operator==(const Grid2DIndex& other) const { return idx == other.idx && idy == other.idy; }
-};
+    int32_t column(double x) const
+    {
+        return clampToGrid((x - _origin.x) * _inverseCellSize, _columns);
+    }
 
-template <>
-struct std::hash<Grid2DIndex> {
-    std::size_t operator()(const Grid2DIndex& id) const noexcept
+    int32_t row(double y) const { return clampToGrid((y - _origin.y) * _inverseCellSize, _rows); }
+
+    uint32_t cellIndex(int32_t column, int32_t row) const
     {
-        std::hash<std::int32_t> hasher{};
-        return jps::hash_combine(hasher(id.idx), hasher(id.idy));
+        return static_cast<uint32_t>(column) * static_cast<uint32_t>(_rows) +
+               static_cast<uint32_t>(row);
     }
-};
 
-template <typename Value>
-class NeighborhoodSearch
-{
-    using Grid = std::unordered_map<Grid2DIndex, std::vector<const Value*>>;
+    /// Positions outside of the grid are mapped to the closest border cell. This keeps queries
+    /// exact, as query ranges are clamped the same way.
+    uint32_t cellIndex(const Point& pos) const { return cellIndex(column(pos.x), row(pos.y)); }
 
-    double _cellSize;
-    Grid _grid{};
+    void setExtent(const AABB& bounds)
+    {
+        const bool empty = bounds.xmin > bounds.xmax || bounds.ymin > bounds.ymax;
+        const double width = empty ? 0. : bounds.xmax - bounds.xmin;
+        const double height = empty ? 0. : bounds.ymax - bounds.ymin;
+        _cellSize = _minCellSize;
+        const auto cellCount = (width / _cellSize + 1) * (height / _cellSize + 1);
+        if(cellCount > MaxCellCount) {
+            _cellSize *= std::sqrt(cellCount / MaxCellCount);
+        }
+        _inverseCellSize = 1. / _cellSize;
+        _origin = empty ? Point{} : Point{bounds.xmin, bounds.ymin};
+        _columns = static_cast<int32_t>(width / _cellSize) + 1;
+        _rows = static_cast<int32_t>(height / _cellSize) + 1;
+        _cellStart.assign(static_cast<size_t>(_columns) * static_cast<size_t>(_rows) + 1, 0);
+    }
 
-private:
-    Grid2DIndex getIndex(const Point& pos) const
+    /// Calls 'fn' with the position in _items of every item within 'radius' of 'pos' that is
+    /// stored in the grid, i.e. not with items added since the last Update().
+    template <typename Fn>
+    void forEachSlot(Point pos, double radius, Fn&& fn) const
+    {
+        const int32_t xMin = column(pos.x - radius);
+        const int32_t xMax = column(pos.x + radius);
+        const int32_t yMin = row(pos.y - radius);
+        const int32_t yMax = row(pos.y + radius);
+
+        const auto radiusSquared = radius * radius;
+        for(int32_t x = xMin; x <= xMax; ++x) {
+            const auto first = _cellStart[cellIndex(x, yMin)];
+            const auto last = _cellStart[cellIndex(x, yMax) + 1];
+            for(auto slot = first; slot < last; ++slot) {
+                if(DistanceSquared(_positions[slot], pos) <= radiusSquared) {
+                    fn(slot);
+                }
+            }
+        }
+    }
+
+    /// Position of 'item' in _items or _items.size() if it is not stored in the grid at its
+    /// current position.
+    uint32_t findSlot(const Value& item) const
+    {
+        const auto cell = cellIndex(item.position());
+        for(auto slot = _cellStart[cell]; slot < _cellStart[cell + 1]; ++slot) {
+            if(_items[slot] == &item) {
+                return slot;
+            }
+        }
+        return static_cast<uint32_t>(_items.size());
+    }
+
+    void swapSlots(uint32_t a, uint32_t b)
+    {
+        std::swap(_items[a], _items[b]);
+        std::swap(_positions[a], _positions[b]);
+        std::swap(_itemIndices[a], _itemIndices[b]);
+        _itemSlots[_itemIndices[a]] = a;
+        _itemSlots[_itemIndices[b]] = b;
+    }
+
+    /// Moves an item from cell 'from' to cell 'to' by passing it along the cells in between:
+    /// the item is swapped to the border of its cell and the cell boundary is shifted past it.
+    /// Costs one swap per cell in between. Leaves the order within the cells passed unsorted,
+    /// see sortCell().
+    void relocate(uint32_t index, uint32_t from, uint32_t to)
+    {
+        auto slot = _itemSlots[index];
+        for(auto cell = from; cell < to; ++cell) {
+            const auto last = _cellStart[cell + 1] - 1;
+            swapSlots(slot, last);
+            slot = last;
+            --_cellStart[cell + 1];
+        }
+        for(auto cell = from; cell > to; --cell) {
+            const auto first = _cellStart[cell];
+            swapSlots(slot, first);
+            slot = first;
+            ++_cellStart[cell];
+        }
+        _itemCells[index] = to;
+    }
+
+    /// Restores the container order within 'cell' that Update() establishes, so that neighbors
+    /// are visited in the same order as after a full Update(). Cells passed by relocate() are
+    /// sorted except for the items swapped to their borders, insertion sort is linear for them.
+    void sortCell(uint32_t cell)
     {
-        const int32_t idx = static_cast<int32_t>(pos.x / _cellSize);
-        const int32_t idy = static_cast<int32_t>(pos.y / _cellSize);
-        return Grid2DIndex{idx, idy};
+        const auto first = _cellStart[cell];
+        const auto last = _cellStart[cell + 1];
+        for(auto slot = first + 1; slot < last; ++slot) {
+            for(auto pos = slot; pos > first && _itemIndices[pos - 1] > _itemIndices[pos]; --pos) {
+                swapSlots(pos - 1, pos);
+            }
+        }
     }
 
 public:
-    explicit NeighborhoodSearch(double cellSize) : _cellSize(cellSize) {};
+    /// Creates a grid that is fitted to the items on every Update().
+    explicit NeighborhoodSearch(double cellSize)
+        : _minCellSize(cellSize), _cellSize(cellSize), _inverseCellSize(1. / cellSize)
+    {
+    }
+
+    /// Creates a grid covering 'bounds', e.g. the bounding box of the geometry. The grid is
+    /// allocated once, items outside of 'bounds' are still found but searched less efficiently.
+    NeighborhoodSearch(double cellSize, const AABB& bounds)
+        : _minCellSize(cellSize)
+        , _cellSize(cellSize)
+        , _inverseCellSize(1. / cellSize)
+        , _hasBounds(true)
+    {
+        setExtent(bounds);
+    }
 
     void AddAgent(const Value& item)
     {
-        auto index = getIndex(item.position());
-        auto& vec = _grid[index];
-        vec.push_back(&item);
+        _added[cellIndex(item.position())].push_back(&item);
+        _listsValid = false;
     }
 
     void RemoveAgent(const Value& item)
     {
-        for(auto& [_, agents] : _grid) {
-            const auto iter =
-                std::find_if(std::begin(agents), std::end(agents), [item](auto& agent) {
-                    return agent.id == item.id;
-                });
+        const auto sameId = [&item](const Value* other) { return other->id == item.id; };
+        for(auto& [_, agents] : _added) {
+            const auto iter = std::find_if(std::begin(agents), std::end(agents), sameId);
             if(iter != std::end(agents)) {
                 agents.erase(iter);
                 return;
             }
         }
+        const auto iter = std::find_if(std::begin(_items), std::end(_items), sameId);
+        if(iter != std::end(_items)) {
+            const auto position = static_cast<uint32_t>(std::distance(std::begin(_items), iter));
+            _items.erase(iter);
+            _positions.erase(std::next(std::begin(_positions), position));
+            // Container indices are unknown from here on, UpdatePositions() has to rebuild
+            _listsValid = false;
+            _itemIndices.clear();
+            _itemCells.clear();
+            _itemSlots.clear();
+            for(auto& start : _cellStart) {
+                if(start > position) {
+                    --start;
+                }
+            }
+            return;
+        }
         throw SimulationError("Unknown agent id {}", item.id);
     }
 
+    /// Rebuilds the grid with a counting sort over the cell index of each item. Items keep their
+    /// container order within a cell. Apart from growing the buffers this does not allocate.
     void Update(const AgentContainer<Value>& items)
     {
-        _grid.clear();
+        _added.clear();
+        _listsValid = false;
+        if(_hasBounds) {
+            std::fill(std::begin(_cellStart), std::end(_cellStart), 0);
+        } else {
+            AABB extent{};
+            for(const auto& item : items) {
+                const auto& pos = item.position();
+                extent.xmin = std::min(extent.xmin, pos.x);
+                extent.xmax = std::max(extent.xmax, pos.x);
+                extent.ymin = std::min(extent.ymin, pos.y);
+                extent.ymax = std::max(extent.ymax, pos.y);
+            }
+            setExtent(extent);
+        }
+
+        _itemCells.resize(items.size());
+        auto cellIter = std::begin(_itemCells);
         for(const auto& item : items) {
-            auto index = getIndex(item.position());
-            auto& vec = _grid[index];
-            vec.push_back(&item);
+            const auto cell = cellIndex(item.position());
+            *cellIter++ = cell;
+            ++_cellStart[cell];
+        }
+        // After the prefix sum _cellStart[c] holds the end of cell 'c'. Filling back to front
+        // moves it to the start of the cell and keeps the order of the items stable.
+        std::partial_sum(std::begin(_cellStart), std::end(_cellStart), std::begin(_cellStart));
+        _items.resize(items.size());
+        _positions.resize(items.size());
+        _itemIndices.resize(items.size());
+        _itemSlots.resize(items.size());
+        auto index = static_cast<uint32_t>(items.size());
+        for(auto iter = std::rbegin(items); iter != std::rend(items); ++iter) {
+            --index;
+            const auto slot = --_cellStart[_itemCells[index]];
+            _items[slot] = &*iter;
+            _positions[slot] = iter->position();
+            _itemIndices[slot] = index;
+            _itemSlots[index] = slot;
         }
     }
 
-    std::vector<Value> GetNeighboringAgents(Point pos, double radius) const
+    /// Brings the grid up to date after the items moved, relocating only items whose cell changed.
+    /// The resulting grid is the same as after a full Update(). 'items' has to contain the same
+    /// items in the same order as on the last Update(), but may live in a different container, e.g.
+    /// after the operational step swapped in the next generation of agents. Falls back to a full
+    /// Update() if items were added since or if relocating would cost more than a rebuild.
+    void UpdatePositions(const AgentContainer<Value>& items)
     {
-        std::vector<Value> result{};
-        result.reserve(128);
+        if(!_added.empty() || items.size() != _itemCells.size()) {
+            Update(items);
+            return;
+        }
 
-        const auto posIdx = getIndex(pos);
-        const auto offset = static_cast<int32_t>(std::ceil(radius / _cellSize));
-        const int32_t xMin = posIdx.idx - offset;
-        const int32_t xMax = posIdx.idx + offset;
-        const int32_t yMin = posIdx.idy - offset;
-        const int32_t yMax = posIdx.idy + offset;
+        // Items of an unchanged container keep their addresses, only a swapped in container
+        // requires to update the stored pointers.
+        const bool repoint = !items.empty() && _items[_itemSlots[0]] != &items.front();
+        _moved.clear();
+        size_t cost = 0;
+        uint32_t index = 0;
+        for(const auto& item : items) {
+            const auto slot = _itemSlots[index];
+            if(repoint) {
+                _items[slot] = &item;
+            }
+            const auto& pos = item.position();
+            _positions[slot] = pos;
+            if(_listsValid) {
+                const auto listSlot = _listSlots[index];
+                _listed[listSlot] = {pos, &item};
+                if(DistanceSquared(pos, _listOrigins[listSlot]) > _maxDisplacementSquared) {
+                    _listsValid = false;
+                }
+            }
+            const auto cell = cellIndex(pos);
+            const auto oldCell = _itemCells[index];
+            if(cell != oldCell) {
+                _moved.push_back({index, oldCell, cell});
+                cost += cell > oldCell ? cell - oldCell : oldCell - cell;
+            }
+            ++index;
+        }
+        if(cost > items.size()) {
+            Update(items);
+            return;
+        }
+        _passedCells.clear();
+        for(const auto& [index, from, to] : _moved) {
+            relocate(index, from, to);
+            for(auto cell = std::min(from, to); cell <= std::max(from, to); ++cell) {
+                _passedCells.push_back(cell);
+            }
+        }
+        std::sort(std::begin(_passedCells), std::end(_passedCells));
+        const auto passedEnd = std::unique(std::begin(_passedCells), std::end(_passedCells));
+        for(auto iter = std::begin(_passedCells); iter != passedEnd; ++iter) {
+            sortCell(*iter);
+        }
+    }
 
+    /// Calls 'fn' with a const reference to every item within 'radius' of 'pos'.
+    /// Items are visited in place, nothing is copied or allocated. The visiting order is
+    /// deterministic for a given grid state.
+    /// The distance test uses the item positions as of the last Update() or UpdatePositions().
+    template <typename Fn>
+    void ForEachNeighbor(Point pos, double radius, Fn&& fn) const
+    {
+        forEachSlot(pos, radius, [this, &fn](uint32_t slot) { fn(*_items[slot]); });
+        if(_added.empty()) {
+            return;
+        }
+        const int32_t xMin = column(pos.x - radius);
+        const int32_t xMax = column(pos.x + radius);
+        const int32_t yMin = row(pos.y - radius);
+        const int32_t yMax = row(pos.y + radius);
         const auto radiusSquared = radius * radius;
-
         for(int32_t x = xMin; x <= xMax; ++x) {
-            for(int32_t y = yMin; y <= yMax; ++y) {
-                auto it = _grid.find({x, y});
-                if(it != _grid.cend()) {
-                    for(const auto& item : it->second) {
-                        if(DistanceSquared((*item).position(), pos) <= radiusSquared) {
-                            result.emplace_back(*item);
+            for(auto cell = cellIndex(x, yMin); cell <= cellIndex(x, yMax); ++cell) {
+                if(const auto it = _added.find(cell); it != _added.end()) {
+                    for(const auto* item : it->second) {
+                        if(DistanceSquared(item->position(), pos) <= radiusSquared) {
+                            fn(*item);
                         }
                     }
                 }
             }
         }
+    }
+
+    /// Same as ForEachNeighbor(item.position(), radius, fn), but served from the Verlet neighbor
+    /// list of 'item' if the lists are up to date and 'radius' does not exceed their cut off
+    /// radius. Falls back to the grid otherwise, e.g. for items moved since the last update.
+    template <typename Fn>
+    void ForEachNeighborOf(const Value& item, double radius, Fn&& fn) const
+    {
+        if(_listsValid && radius <= _listCutOffRadius) {
+            if(const auto slot = findSlot(item); slot < _items.size()) {
+                const auto pos = _positions[slot];
+                const auto radiusSquared = radius * radius;
+                const auto listSlot = _listSlots[_itemIndices[slot]];
+                for(auto entry = _listStart[listSlot]; entry < _listStart[listSlot + 1]; ++entry) {
+                    const auto& neighbor = _listed[_listItems[entry]];
+                    if(DistanceSquared(neighbor.position, pos) <= radiusSquared) {
+                        fn(*neighbor.item);
+                    }
+                }
+                return;
+            }
+        }
+        ForEachNeighbor(item.position(), radius, std::forward<Fn>(fn));
+    }
+
+    /// Enables Verlet neighbor lists for ForEachNeighborOf(): each item keeps the list of items
+    /// within 'cutOffRadius' + 'skin'. The lists stay exact for queries up to 'cutOffRadius' as
+    /// long as no item moved more than half the skin, so they only need to be rebuilt every few
+    /// iterations instead of searching the grid for every query.
+    void EnableNeighborLists(double cutOffRadius, double skin)
+    {
+        _listsEnabled = true;
+        _listsValid = false;
+        _listCutOffRadius = cutOffRadius;
+        _listRadius = cutOffRadius + skin;
+        _maxDisplacementSquared = 0.25 * skin * skin;
+    }
+
+    void DisableNeighborLists()
+    {
+        _listsEnabled = false;
+        _listsValid = false;
+        _listStart.clear();
+        _listItems.clear();
+        _listOrigins.clear();
+        _listed.clear();
+        _listSlots.clear();
+    }
+
+    bool NeighborListsEnabled() const { return _listsEnabled; }
+
+    /// True if neighbor lists are enabled but have to be rebuilt because items moved too far,
+    /// were added or removed since the last RebuildNeighborLists().
+    bool NeighborListsOutdated() const { return _listsEnabled && !_listsValid; }
+
+    /// Rebuilds the neighbor lists from the grid. Has no effect unless the grid is up to date,
+    /// i.e. Update() or UpdatePositions() were called after adding or removing items.
+    void RebuildNeighborLists()
+    {
+        if(!_listsEnabled || !_added.empty() || _itemSlots.size() != _items.size()) {
+            return;
+        }
+        _listOrigins = _positions;
+        _listSlots = _itemSlots;
+        _listed.resize(_items.size());
+        _listStart.resize(_items.size() + 1);
+        _listItems.clear();
+        for(uint32_t slot = 0; slot < _items.size(); ++slot) {
+            _listed[slot] = {_positions[slot], _items[slot]};
+            _listStart[slot] = static_cast<uint32_t>(_listItems.size());
+            forEachSlot(_positions[slot], _listRadius, [this](uint32_t neighborSlot) {
+                _listItems.push_back(neighborSlot);
+            });
+        }
+        _listStart.back() = static_cast<uint32_t>(_listItems.size());
+        _listsValid = true;
+    }
+
+    /// Stores pointers to all items within 'radius' of 'pos' in 'result'. 'result' is cleared
+    /// first, reusing it across queries avoids allocations. Pointers are valid until the next
+    /// Update().
+    void GetNeighboringAgents(Point pos, double radius, std::vector<const Value*>& result) const
+    {
+        result.clear();
+        ForEachNeighbor(pos, radius, [&result](const Value& item) { result.push_back(&item); });
+    }
+
+    /// Returns copies of all items within 'radius' of 'pos'. Prefer ForEachNeighbor() in hot
+    /// code paths.
+    std::vector<Value> GetNeighboringAgents(Point pos, double radius) const
+    {
+        std::vector<Value> result{};
+        result.reserve(128);
+        ForEachNeighbor(pos, radius, [&result](const Value& item) { result.emplace_back(item); });
         return result;
     }
 };
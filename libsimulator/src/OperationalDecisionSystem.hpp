@@ -1,24 +1,101 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AnticipationVelocityModel.hpp"
+#include "CollisionFreeSpeedModel.hpp"
+#include "CollisionFreeSpeedModelV2.hpp"
+#include "CollisionFreeSpeedModelV3.hpp"
 #include "CollisionGeometry.hpp"
+#include "GeneralizedCentrifugalForceModel.hpp"
 #include "GenericAgent.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
+#include "SocialForceModel.hpp"
+#include "ThreadPool.hpp"
+#include "WarpDriverModel.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 class OperationalDecisionSystem
 {
+    /// Computes the next state of the agents [begin, end) into the matching slots of 'next'.
+    using StepFn = void (*)(
+        const OperationalModel& model,
+        double dT,
+        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        const CollisionGeometry& geometry,
+        const AgentContainer<GenericAgent>& current,
+        AgentContainer<GenericAgent>& next,
+        size_t begin,
+        size_t end);
+
     std::unique_ptr<OperationalModel> _model{};
+    StepFn _step{};
     AgentContainer<GenericAgent> _next{};
+    std::unique_ptr<ThreadPool> _threadPool{std::make_unique<ThreadPool>(1)};
+
+    /// Loop over the agents specialised for the concrete model type. The built-in models are
+    /// final, so the call binds statically and the per agent virtual dispatch is gone.
+    /// The built-in models write the complete model state of 'next', only the remaining agent
+    /// data is synchronised. Custom models get a full copy of the current agent.
+    template <typename Model>
+    static void step(
+        const OperationalModel& model,
+        double dT,
+        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        const CollisionGeometry& geometry,
+        const AgentContainer<GenericAgent>& current,
+        AgentContainer<GenericAgent>& next,
+        size_t begin,
+        size_t end)
+    {
+        const auto& concreteModel = static_cast<const Model&>(model);
+        for(size_t index = begin; index < end; ++index) {
+            if constexpr(std::is_same_v<Model, OperationalModel>) {
+                next[index] = current[index];
+            } else {
+                next[index].AssignAllButModel(current[index]);
+            }
+            concreteModel.ComputeNextState(
+                dT, current[index], next[index], geometry, neighborhoodSearch);
+        }
+    }
+
+    /// Type() identifies the concrete class: the built-in models are final and CustomModel does
+    /// not allow subclasses to change their type.
+    static StepFn selectStep(OperationalModelType type)
+    {
+        switch(type) {
+            case OperationalModelType::COLLISION_FREE_SPEED:
+                return step<CollisionFreeSpeedModel>;
+            case OperationalModelType::GENERALIZED_CENTRIFUGAL_FORCE:
+                return step<GeneralizedCentrifugalForceModel>;
+            case OperationalModelType::COLLISION_FREE_SPEED_V2:
+                return step<CollisionFreeSpeedModelV2>;
+            case OperationalModelType::COLLISION_FREE_SPEED_V3:
+                return step<CollisionFreeSpeedModelV3>;
+            case OperationalModelType::ANTICIPATION_VELOCITY_MODEL:
+                return step<AnticipationVelocityModel>;
+            case OperationalModelType::SOCIAL_FORCE:
+                return step<SocialForceModel>;
+            case OperationalModelType::WARP_DRIVER:
+                return step<WarpDriverModel>;
+            case OperationalModelType::CUSTOM_MODEL:
+                // User defined subclasses, keep the virtual call
+                return step<OperationalModel>;
+        }
+        return step<OperationalModel>;
+    }
 
 public:
-    OperationalDecisionSystem(std::unique_ptr<OperationalModel>&& model) : _model(std::move(model))
+    OperationalDecisionSystem(std::unique_ptr<OperationalModel>&& model)
+        : _model(std::move(model)), _step(selectStep(_model->Type()))
     {
     }
     ~OperationalDecisionSystem() = default;
@@ -29,6 +106,18 @@ public:
 
     OperationalModelType ModelType() const { return _model->Type(); }
 
+    double CutOffRadius() const { return _model->CutOffRadius(); }
+
+    /// Number of threads computing the operational step, 1 runs the serial loop. Models that do
+    /// not support parallel execution are always stepped serially.
+    size_t ThreadCount() const { return _threadPool->ThreadCount(); }
+    void SetThreadCount(size_t threadCount)
+    {
+        if(threadCount != ThreadCount()) {
+            _threadPool = std::make_unique<ThreadPool>(threadCount);
+        }
+    }
+
     void
     Run(double dT,
         double /*t_in_sec*/,
@@ -36,15 +125,28 @@ public:
         const CollisionGeometry& geometry,
         AgentContainer<GenericAgent>& agents)
     {
-        _next.clear();
-        std::copy(std::begin(agents), std::end(agents), std::back_inserter(_next));
-        for(size_t index = 0; index < agents.size(); ++index) {
-            _model->ComputeNextState(dT, agents[index], _next[index], geometry, neighborhoodSearch);
+        // "_next" holds the previous generation after the last swap. Its slots are recycled and
+        // overwritten by the step, only a changed agent count needs to resize the buffer.
+        if(_next.size() > agents.size()) {
+            _next.erase(std::next(std::begin(_next), agents.size()), std::end(_next));
+        } else if(_next.size() < agents.size()) {
+            _next.insert(
+                std::end(_next), std::next(std::begin(agents), _next.size()), std::end(agents));
+        }
+        const auto step = [&](size_t begin, size_t end) {
+            _step(*_model, dT, neighborhoodSearch, geometry, agents, _next, begin, end);
+        };
+        // Each agent only writes its own slot in "_next" and reads the frozen current
+        // generation, hence the result does not depend on how agents are split across threads.
+        if(_model->SupportsParallelExecution()) {
+            _threadPool->ParallelFor(agents.size(), step);
+        } else {
+            step(0, agents.size());
         }
         // Swap in the computed generation. This is safe because no caller retains
         // pointers/references across an iteration (Python-side agent handles resolve per
-        // access) and Simulation::Iterate rebuilds the neighborhood grid right after this
-        // step.
+        // access) and Simulation::Iterate updates the neighborhood grid with the swapped
+        // container right after this step.
         agents.swap(_next);
     }
 
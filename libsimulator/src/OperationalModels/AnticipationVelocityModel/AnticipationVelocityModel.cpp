@@ -5,6 +5,7 @@
 #include "GenericAgent.hpp"
 #include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 #include "Macros.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
@@ -14,6 +15,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
@@ -21,7 +23,7 @@
 #include <vector>
 
 AnticipationVelocityModel::AnticipationVelocityModel(double pushoutStrength, uint64_t rng_seed)
-    : _pushoutStrength(pushoutStrength), gen(rng_seed)
+    : _pushoutStrength(pushoutStrength), _rngSeed(rng_seed)
 {
 }
 
@@ -38,40 +40,37 @@ void AnticipationVelocityModel::ComputeNextState(
     const NeighborhoodSearch<GenericAgent>& neighborhoodSearch) const
 {
     const auto& model = std::get<State>(current.model);
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(model.position, _cutOffRadius);
+    CounterBasedRng rng(_rngSeed, current.id.getID(), model.rngCounter);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(model.position);
 
-    // Remove any agent from the neighborhood that is obstructed by geometry and the current
-    // agent
-    neighborhood.erase(
-        std::remove_if(
-            std::begin(neighborhood),
-            std::end(neighborhood),
-            [&current, &model, &boundary](const auto& neighbor) {
-                if(current.id == neighbor.id) {
-                    return true;
-                }
-                const auto agent_to_neighbor =
-                    LineSegment(model.position, std::get<State>(neighbor.model).position);
-                if(std::find_if(
-                       boundary.cbegin(),
-                       boundary.cend(),
-                       [&agent_to_neighbor](const auto& boundary_segment) {
-                           return intersects(agent_to_neighbor, boundary_segment);
-                       }) != boundary.end()) {
-                    return true;
-                }
-
-                return false;
-            }),
-        std::end(neighborhood));
+    // Neighbors not obstructed by geometry, excluding the current agent. The buffer is reused
+    // between calls to avoid allocations.
+    thread_local std::vector<const GenericAgent*> neighborhood{};
+    neighborhood.clear();
+    neighborhoodSearch.ForEachNeighborOf(
+        current, _cutOffRadius, [&current, &model, &boundary](const auto& neighbor) {
+            if(current.id == neighbor.id) {
+                return;
+            }
+            const auto agent_to_neighbor =
+                LineSegment(model.position, std::get<State>(neighbor.model).position);
+            if(std::any_of(
+                   std::begin(boundary),
+                   std::end(boundary),
+                   [&agent_to_neighbor](const auto& segment) {
+                       return intersects(agent_to_neighbor, segment);
+                   })) {
+                return;
+            }
+            neighborhood.push_back(&neighbor);
+        });
 
     const auto neighborRepulsion = std::accumulate(
         std::begin(neighborhood),
         std::end(neighborhood),
         Point{},
-        [&current, this](const auto& res, const auto& neighbor) {
-            return res + NeighborRepulsion(current, neighbor);
+        [&current, &rng, this](const auto& res, const auto& neighbor) {
+            return res + NeighborRepulsion(current, *neighbor, rng);
         });
 
     const auto desiredDirection = (current.nextTarget - model.position).Normalized();
@@ -90,18 +89,25 @@ void AnticipationVelocityModel::ComputeNextState(
         std::end(neighborhood),
         std::numeric_limits<double>::max(),
         [&current, &direction, this](const auto& res, const auto& neighbor) {
-            return std::min(res, GetSpacing(current, neighbor, direction));
+            return std::min(res, GetSpacing(current, *neighbor, direction));
         });
 
-    const auto optimal_speed = OptimalSpeed(current, spacing, model.timeGap);
+    const auto optimal_speed = OptimalSpeed(current, spacing, model.timeGap, rng);
     direction = HandleWallAvoidance(
-        direction, model.position, model.radius, boundary, wallBufferDistance, _pushoutStrength);
+        direction,
+        model.position,
+        model.radius,
+        geometry.LineSegmentBlockInApproxDistanceTo(model.position),
+        wallBufferDistance,
+        _pushoutStrength);
 
     const auto velocity = direction * optimal_speed;
     auto& nextModel = std::get<State>(next.model);
+    nextModel = model;
     nextModel.position = model.position + velocity * dT;
     nextModel.orientation = direction;
     nextModel.velocity = velocity;
+    nextModel.rngCounter = model.rngCounter + 1;
 };
 
 Point AnticipationVelocityModel::UpdateDirection(
@@ -175,10 +181,9 @@ void AnticipationVelocityModel::CheckModelConstraint(
     constexpr double reactionTimeMax = 1.0;
     validateConstraint(reactionTime, reactionTimeMin, reactionTimeMax, "reactionTime", true);
 
-    const auto neighbors = neighborhoodSearch.GetNeighboringAgents(model.position, 2);
-    for(const auto& neighbor : neighbors) {
+    neighborhoodSearch.ForEachNeighbor(model.position, 2, [&](const auto& neighbor) {
         if(agent.id == neighbor.id) {
-            continue;
+            return;
         }
         const auto& neighbor_model = std::get<State>(neighbor.model);
         const auto contanctdDist = r + neighbor_model.radius;
@@ -190,7 +195,7 @@ void AnticipationVelocityModel::CheckModelConstraint(
                 neighbor_model.position,
                 distance);
         }
-    }
+    });
 
     const auto lineSegments = geometry.LineSegmentsInDistanceTo(r, model.position);
     if(std::begin(lineSegments) != std::end(lineSegments)) {
@@ -205,7 +210,8 @@ void AnticipationVelocityModel::CheckModelConstraint(
 double AnticipationVelocityModel::OptimalSpeed(
     const GenericAgent& ped,
     double spacing,
-    double time_gap) const
+    double time_gap,
+    CounterBasedRng& rng) const
 {
     const auto& model = std::get<State>(ped.model);
     constexpr double creep_speed = 0.01;
@@ -214,7 +220,7 @@ double AnticipationVelocityModel::OptimalSpeed(
 
     if(std::abs(speed) < creep_speed) {
         // Random shuffle: forward, backward, or stop
-        const auto r = gen() % 3;
+        const auto r = rng() % 3;
         speed = (r == 0) ? creep_speed : (r == 1) ? -creep_speed : 0.0;
     }
 
@@ -245,7 +251,8 @@ double AnticipationVelocityModel::GetSpacing(
 
 Point AnticipationVelocityModel::CalculateInfluenceDirection(
     const Point& desiredDirection,
-    const Point& predictedDirection) const
+    const Point& predictedDirection,
+    CounterBasedRng& rng) const
 {
     // Eq. (5)
     const Point orthogonalDirection = Point(-desiredDirection.y, desiredDirection.x).Normalized();
@@ -253,7 +260,7 @@ Point AnticipationVelocityModel::CalculateInfluenceDirection(
     Point influenceDirection = orthogonalDirection;
     if(fabs(alignment) < J_EPS) {
         // Choose a random direction (left or right)
-        if(gen() % 2 == 0) {
+        if(rng() % 2 == 0) {
             influenceDirection = -orthogonalDirection;
         }
     } else if(alignment > 0) {
@@ -264,7 +271,8 @@ Point AnticipationVelocityModel::CalculateInfluenceDirection(
 
 Point AnticipationVelocityModel::NeighborRepulsion(
     const GenericAgent& ped1,
-    const GenericAgent& ped2) const
+    const GenericAgent& ped2,
+    CounterBasedRng& rng) const
 {
     const auto& model1 = std::get<State>(ped1.model);
     const auto& model2 = std::get<State>(ped2.model);
@@ -297,7 +305,7 @@ Point AnticipationVelocityModel::NeighborRepulsion(
     const auto newep12 = distp12 + model2.velocity * model2.anticipationTime; // e_ij(t+ta)
 
     // Compute adjusted influence direction
-    const auto influenceDirection = CalculateInfluenceDirection(d1, newep12);
+    const auto influenceDirection = CalculateInfluenceDirection(d1, newep12, rng);
     return influenceDirection * interactionStrength;
 }
 
@@ -305,7 +313,7 @@ Point AnticipationVelocityModel::HandleWallAvoidance(
     const Point& direction,
     const Point& agentPosition,
     double agentRadius,
-    const std::vector<LineSegment>& boundary,
+    const LineSegmentBlock& boundary,
     double wallBufferDistance,
     double pushoutStrength) const
 {
@@ -313,8 +321,10 @@ Point AnticipationVelocityModel::HandleWallAvoidance(
 
     Point modifiedDirection = direction;
 
-    for(const auto& wall : boundary) {
-        const auto closestPoint = wall.ShortestPoint(agentPosition);
+    thread_local ClosestPoints closest{};
+    boundary.ClosestPointsTo(agentPosition, closest);
+    for(size_t index = 0; index < closest.Size(); ++index) {
+        const auto closestPoint = closest.At(index);
 
         const auto distanceVector = agentPosition - closestPoint;
         const auto [distance, normalTowardAgent] = distanceVector.NormAndNormalized();
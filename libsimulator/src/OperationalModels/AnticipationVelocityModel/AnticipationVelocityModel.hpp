@@ -2,7 +2,9 @@
 #pragma once
 
 #include "CollisionGeometry.hpp"
+#include "CounterBasedRng.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
@@ -10,10 +12,9 @@
 #include <fmt/core.h>
 
 #include <cstdint>
-#include <random>
 #include <vector>
 
-class AnticipationVelocityModel : public OperationalModel
+class AnticipationVelocityModel final : public OperationalModel
 {
 public:
     /// Per-agent state of the anticipation velocity model.
@@ -29,19 +30,21 @@ public:
         double timeGap{1.06};
         double v0{1.2};
         double radius{0.2};
+        uint64_t rngCounter{0}; // steps taken, selects the agent's random numbers per step
     };
 
 private:
     /// Add a small outward component to maintain minimum distance from walls.
     double _pushoutStrength{0.3};
     double _cutOffRadius{3};
-    // Shared sequential RNG: draws must stay on the model to keep simulations deterministic.
-    mutable std::mt19937 gen;
+    // Seed of the per-agent counter based random streams.
+    uint64_t _rngSeed;
 
 public:
     AnticipationVelocityModel(double pushoutStrength, uint64_t rng_seed);
     ~AnticipationVelocityModel() override = default;
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
     void ComputeNextState(
         double dT,
         const GenericAgent& current,
@@ -54,19 +57,27 @@ public:
         const CollisionGeometry& geometry) const override;
 
 private:
-    double OptimalSpeed(const GenericAgent& ped, double spacing, double time_gap) const;
+    double OptimalSpeed(
+        const GenericAgent& ped,
+        double spacing,
+        double time_gap,
+        CounterBasedRng& rng) const;
     Point CalculateInfluenceDirection(
         const Point& desiredDirection,
-        const Point& predictedDirection) const;
+        const Point& predictedDirection,
+        CounterBasedRng& rng) const;
     double
     GetSpacing(const GenericAgent& ped1, const GenericAgent& ped2, const Point& direction) const;
-    Point NeighborRepulsion(const GenericAgent& ped1, const GenericAgent& ped2) const;
+    Point NeighborRepulsion(
+        const GenericAgent& ped1,
+        const GenericAgent& ped2,
+        CounterBasedRng& rng) const;
 
     Point HandleWallAvoidance(
         const Point& direction,
         const Point& agentPosition,
         double agentRadius,
-        const std::vector<LineSegment>& boundary,
+        const LineSegmentBlock& boundary,
         double wallBufferDistance,
         double pushoutStrength) const;
 
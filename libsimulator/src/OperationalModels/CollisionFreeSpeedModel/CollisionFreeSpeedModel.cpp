@@ -5,6 +5,7 @@
 #include "GenericAgent.hpp"
 #include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -13,6 +14,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <limits>
 #include <numeric>
@@ -43,49 +45,50 @@ void CollisionFreeSpeedModel::ComputeNextState(
     const NeighborhoodSearch<GenericAgent>& neighborhoodSearch) const
 {
     const auto& model = std::get<State>(current.model);
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(model.position, _cutOffRadius);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(model.position);
 
-    // Remove any agent from the neighborhood that is obstructed by geometry and the current
-    // agent
-    neighborhood.erase(
-        std::remove_if(
-            std::begin(neighborhood),
-            std::end(neighborhood),
-            [&current, &model, &boundary](const auto& neighbor) {
-                if(current.id == neighbor.id) {
-                    return true;
-                }
-                const auto agent_to_neighbor =
-                    LineSegment(model.position, std::get<State>(neighbor.model).position);
-                if(std::find_if(
-                       boundary.cbegin(),
-                       boundary.cend(),
-                       [&agent_to_neighbor](const auto& boundary_segment) {
-                           return intersects(agent_to_neighbor, boundary_segment);
-                       }) != boundary.end()) {
-                    return true;
-                }
-
-                return false;
-            }),
-        std::end(neighborhood));
+    // Neighbors not obstructed by geometry, excluding the current agent. The buffer is reused
+    // between calls to avoid allocations.
+    thread_local std::vector<const GenericAgent*> neighborhood{};
+    neighborhood.clear();
+    neighborhoodSearch.ForEachNeighborOf(
+        current, _cutOffRadius, [&current, &model, &boundary](const auto& neighbor) {
+            if(current.id == neighbor.id) {
+                return;
+            }
+            const auto agent_to_neighbor =
+                LineSegment(model.position, std::get<State>(neighbor.model).position);
+            if(std::any_of(
+                   std::begin(boundary),
+                   std::end(boundary),
+                   [&agent_to_neighbor](const auto& segment) {
+                       return intersects(agent_to_neighbor, segment);
+                   })) {
+                return;
+            }
+            neighborhood.push_back(&neighbor);
+        });
 
     const auto neighborRepulsion = std::accumulate(
         std::begin(neighborhood),
         std::end(neighborhood),
         Point{},
         [&current, this](const auto& res, const auto& neighbor) {
-            return res + NeighborRepulsion(current, neighbor);
+            return res + NeighborRepulsion(current, *neighbor);
         });
 
-    const auto boundaryRepulsion = std::accumulate(
-        boundary.cbegin(),
-        boundary.cend(),
-        Point(0, 0),
-        [this, &current](const auto& acc, const auto& element) {
-            return acc + BoundaryRepulsion(current, element);
-        });
+    // The wall distance field only knows the closest wall, without it all nearby walls repel
+    Point boundaryRepulsion{};
+    if(const auto* wallDistances = geometry.WallDistances(); wallDistances != nullptr) {
+        boundaryRepulsion = BoundaryRepulsion(current, wallDistances->SampleAt(model.position));
+    } else {
+        thread_local ClosestPoints closest{};
+        geometry.LineSegmentBlockInApproxDistanceTo(model.position)
+            .ClosestPointsTo(model.position, closest);
+        for(size_t index = 0; index < closest.Size(); ++index) {
+            boundaryRepulsion += BoundaryRepulsion(current, closest.At(index));
+        }
+    }
 
     const auto desired_direction = (current.nextTarget - model.position).Normalized();
     auto direction = (desired_direction + neighborRepulsion + boundaryRepulsion).Normalized();
@@ -97,12 +100,13 @@ void CollisionFreeSpeedModel::ComputeNextState(
         std::end(neighborhood),
         std::numeric_limits<double>::max(),
         [&current, &direction, this](const auto& res, const auto& neighbor) {
-            return std::min(res, GetSpacing(current, neighbor, direction));
+            return std::min(res, GetSpacing(current, *neighbor, direction));
         });
 
     const auto optimal_speed = OptimalSpeed(current, spacing, model.timeGap);
     const auto velocity = direction * optimal_speed;
     auto& nextModel = std::get<State>(next.model);
+    nextModel = model;
     nextModel.position = model.position + velocity * dT;
     nextModel.orientation = direction;
 };
@@ -129,10 +133,9 @@ void CollisionFreeSpeedModel::CheckModelConstraint(
     constexpr double timeGapMax = 10.;
     validateConstraint(timeGap, timeGapMin, timeGapMax, "timeGap");
 
-    const auto neighbors = neighborhoodSearch.GetNeighboringAgents(model.position, 2);
-    for(const auto& neighbor : neighbors) {
+    neighborhoodSearch.ForEachNeighbor(model.position, 2, [&](const auto& neighbor) {
         if(agent.id == neighbor.id) {
-            continue;
+            return;
         }
         const auto& neighbor_model = std::get<State>(neighbor.model);
         const auto contanctdDist = r + neighbor_model.radius;
@@ -144,7 +147,7 @@ void CollisionFreeSpeedModel::CheckModelConstraint(
                 neighbor_model.position,
                 distance);
         }
-    }
+    });
 
     const auto lineSegments = geometry.LineSegmentsInDistanceTo(r, model.position);
     if(std::begin(lineSegments) != std::end(lineSegments)) {
@@ -198,16 +201,25 @@ Point CollisionFreeSpeedModel::NeighborRepulsion(const GenericAgent& ped1, const
            -(this->strengthNeighborRepulsion * exp((l - distance) / this->rangeNeighborRepulsion));
 }
 
-Point CollisionFreeSpeedModel::BoundaryRepulsion(
-    const GenericAgent& ped,
-    const LineSegment& boundary_segment) const
+Point CollisionFreeSpeedModel::BoundaryRepulsion(const GenericAgent& ped, Point closestPoint) const
 {
     const auto& model = std::get<State>(ped.model);
-    const auto pt = boundary_segment.ShortestPoint(model.position);
-    const auto dist_vec = pt - model.position;
+    const auto dist_vec = closestPoint - model.position;
     const auto [dist, e_iw] = dist_vec.NormAndNormalized();
     const auto l = model.radius;
     const auto R_iw =
         -this->strengthGeometryRepulsion * exp((l - dist) / this->rangeGeometryRepulsion);
     return e_iw * R_iw;
 }
+
+Point CollisionFreeSpeedModel::BoundaryRepulsion(
+    const GenericAgent& ped,
+    const WallDistanceField::Sample& wallDistance) const
+{
+    const auto& model = std::get<State>(ped.model);
+    const auto e_iw = -wallDistance.gradient.Normalized();
+    const auto l = model.radius;
+    const auto R_iw = -this->strengthGeometryRepulsion *
+                      exp((l - wallDistance.distance) / this->rangeGeometryRepulsion);
+    return e_iw * R_iw;
+}
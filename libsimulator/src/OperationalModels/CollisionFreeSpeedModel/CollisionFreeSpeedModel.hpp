@@ -6,10 +6,11 @@
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
+#include "WallDistanceField.hpp"
 
 #include <fmt/core.h>
 
-class CollisionFreeSpeedModel : public OperationalModel
+class CollisionFreeSpeedModel final : public OperationalModel
 {
 public:
     /// Per-agent state of the collision free speed model.
@@ -36,6 +37,7 @@ public:
         double rangeGeometryRepulsion);
     ~CollisionFreeSpeedModel() override = default;
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
     void ComputeNextState(
         double dT,
         const GenericAgent& current,
@@ -52,7 +54,10 @@ private:
     double
     GetSpacing(const GenericAgent& ped1, const GenericAgent& ped2, const Point& direction) const;
     Point NeighborRepulsion(const GenericAgent& ped1, const GenericAgent& ped2) const;
-    Point BoundaryRepulsion(const GenericAgent& ped, const LineSegment& boundary_segment) const;
+    Point BoundaryRepulsion(const GenericAgent& ped, Point closestPoint) const;
+    Point BoundaryRepulsion(
+        const GenericAgent& ped,
+        const WallDistanceField::Sample& wallDistance) const;
 };
 
 template <>
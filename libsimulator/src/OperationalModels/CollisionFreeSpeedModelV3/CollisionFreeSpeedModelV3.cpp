@@ -5,6 +5,7 @@
 #include "GenericAgent.hpp"
 #include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -13,6 +14,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <limits>
 #include <numeric>
 #include <vector>
@@ -28,7 +30,7 @@ constexpr double MinReverseSpeed =
     -0.01; // Deterministic tiny reverse floor [m/s] to release local blockages.
 
 double NeighborInfluence(
-    const std::vector<GenericAgent>& neighborhood,
+    const std::vector<const GenericAgent*>& neighborhood,
     const Point& pos,
     const Point& reference_direction,
     const CollisionFreeSpeedModelV3::State& model)
@@ -42,7 +44,7 @@ double NeighborInfluence(
     double best_weight = 0.0;
     for(const auto& neighbor : neighborhood) {
         const auto relative =
-            std::get<CollisionFreeSpeedModelV3::State>(neighbor.model).position - pos;
+            std::get<CollisionFreeSpeedModelV3::State>(neighbor->model).position - pos;
         const auto x = reference_direction.ScalarProduct(relative);
         if(x <= 0.0) {
             continue;
@@ -76,29 +78,43 @@ void CollisionFreeSpeedModelV3::ComputeNextState(
     const NeighborhoodSearch<GenericAgent>& neighborhoodSearch) const
 {
     const auto& model = std::get<State>(current.model);
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(model.position, _cutOffRadius);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(model.position);
 
-    std::erase_if(neighborhood, [&current, &model, &boundary](const auto& neighbor) {
-        if(current.id == neighbor.id) {
-            return true;
-        }
-        const auto agent_to_neighbor =
-            LineSegment(model.position, std::get<State>(neighbor.model).position);
-        return std::any_of(
-            boundary.cbegin(), boundary.cend(), [&agent_to_neighbor](const auto& segment) {
-                return intersects(agent_to_neighbor, segment);
-            });
-    });
-
-    const auto boundaryRepulsion = std::accumulate(
-        boundary.cbegin(),
-        boundary.cend(),
-        Point(0, 0),
-        [this, &current](const auto& acc, const auto& element) {
-            return acc + BoundaryRepulsion(current, element);
+    // Neighbors not obstructed by geometry, excluding the current agent. The buffer is reused
+    // between calls to avoid allocations.
+    thread_local std::vector<const GenericAgent*> neighborhood{};
+    neighborhood.clear();
+    neighborhoodSearch.ForEachNeighborOf(
+        current, _cutOffRadius, [&current, &model, &boundary](const auto& neighbor) {
+            if(current.id == neighbor.id) {
+                return;
+            }
+            const auto agent_to_neighbor =
+                LineSegment(model.position, std::get<State>(neighbor.model).position);
+            if(std::any_of(
+                   std::begin(boundary),
+                   std::end(boundary),
+                   [&agent_to_neighbor](const auto& segment) {
+                       return intersects(agent_to_neighbor, segment);
+                   })) {
+                return;
+            }
+            neighborhood.push_back(&neighbor);
         });
 
+    // The wall distance field only knows the closest wall, without it all nearby walls repel
+    Point boundaryRepulsion{};
+    if(const auto* wallDistances = geometry.WallDistances(); wallDistances != nullptr) {
+        boundaryRepulsion = BoundaryRepulsion(current, wallDistances->SampleAt(model.position));
+    } else {
+        thread_local ClosestPoints closest{};
+        geometry.LineSegmentBlockInApproxDistanceTo(model.position)
+            .ClosestPointsTo(model.position, closest);
+        for(size_t index = 0; index < closest.Size(); ++index) {
+            boundaryRepulsion += BoundaryRepulsion(current, closest.At(index));
+        }
+    }
+
     const auto desired_direction = (current.nextTarget - model.position).Normalized();
     auto reference_direction = (desired_direction + boundaryRepulsion).Normalized();
     if(reference_direction == Point{}) {
@@ -120,7 +136,7 @@ void CollisionFreeSpeedModelV3::ComputeNextState(
         std::end(neighborhood),
         std::numeric_limits<double>::max(),
         [&current, &direction, this](const auto& res, const auto& neighbor) {
-            return std::min(res, GetSpacing(current, neighbor, direction));
+            return std::min(res, GetSpacing(current, *neighbor, direction));
         });
 
     const auto goal_direction =
@@ -130,7 +146,7 @@ void CollisionFreeSpeedModelV3::ComputeNextState(
         std::end(neighborhood),
         std::numeric_limits<double>::max(),
         [&current, &goal_direction, this](const auto& res, const auto& neighbor) {
-            return std::min(res, GetSpacing(current, neighbor, goal_direction));
+            return std::min(res, GetSpacing(current, *neighbor, goal_direction));
         });
 
     const auto spacing =
@@ -139,6 +155,7 @@ void CollisionFreeSpeedModelV3::ComputeNextState(
     const auto optimal_speed = OptimalSpeed(current, spacing, model.timeGap);
     const auto velocity = direction * optimal_speed;
     auto& nextModel = std::get<State>(next.model);
+    nextModel = model;
     nextModel.position = model.position + velocity * dT;
     nextModel.orientation = direction;
     nextModel.headingAngle = heading_angle;
@@ -181,10 +198,9 @@ void CollisionFreeSpeedModelV3::CheckModelConstraint(
     validateConstraint(model.thetaMaxUpperBound, 0.0, std::acos(-1.0), "thetaMaxUpperBound");
     validateConstraint(model.agentBuffer, 0.0, 100.0, "agentBuffer");
 
-    const auto neighbors = neighborhoodSearch.GetNeighboringAgents(model.position, 2);
-    for(const auto& neighbor : neighbors) {
+    neighborhoodSearch.ForEachNeighbor(model.position, 2, [&](const auto& neighbor) {
         if(agent.id == neighbor.id) {
-            continue;
+            return;
         }
         const auto& neighbor_model = std::get<State>(neighbor.model);
         const auto contactDist = model.radius + neighbor_model.radius;
@@ -196,7 +212,7 @@ void CollisionFreeSpeedModelV3::CheckModelConstraint(
                 neighbor_model.position,
                 distance);
         }
-    }
+    });
 
     const auto lineSegments = geometry.LineSegmentsInDistanceTo(model.radius, model.position);
     if(std::begin(lineSegments) != std::end(lineSegments)) {
@@ -242,14 +258,25 @@ double CollisionFreeSpeedModelV3::GetSpacing(
 
 Point CollisionFreeSpeedModelV3::BoundaryRepulsion(
     const GenericAgent& ped,
-    const LineSegment& boundary_segment) const
+    Point closestPoint) const
 {
     const auto& model = std::get<State>(ped.model);
-    const auto pt = boundary_segment.ShortestPoint(model.position);
-    const auto dist_vec = pt - model.position;
+    const auto dist_vec = closestPoint - model.position;
     const auto [dist, e_iw] = dist_vec.NormAndNormalized();
     const auto l = model.radius;
     const auto R_iw =
         -model.strengthGeometryRepulsion * std::exp((l - dist) / model.rangeGeometryRepulsion);
     return e_iw * R_iw;
 }
+
+Point CollisionFreeSpeedModelV3::BoundaryRepulsion(
+    const GenericAgent& ped,
+    const WallDistanceField::Sample& wallDistance) const
+{
+    const auto& model = std::get<State>(ped.model);
+    const auto e_iw = -wallDistance.gradient.Normalized();
+    const auto l = model.radius;
+    const auto R_iw = -model.strengthGeometryRepulsion *
+                      std::exp((l - wallDistance.distance) / model.rangeGeometryRepulsion);
+    return e_iw * R_iw;
+}
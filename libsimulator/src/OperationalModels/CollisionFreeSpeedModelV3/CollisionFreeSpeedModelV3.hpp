@@ -6,10 +6,11 @@
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
+#include "WallDistanceField.hpp"
 
 #include <fmt/core.h>
 
-class CollisionFreeSpeedModelV3 : public OperationalModel
+class CollisionFreeSpeedModelV3 final : public OperationalModel
 {
 public:
     /// Per-agent state of the collision free speed model v3.
@@ -39,6 +40,7 @@ public:
     CollisionFreeSpeedModelV3() = default;
     ~CollisionFreeSpeedModelV3() override = default;
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
     void ComputeNextState(
         double dT,
         const GenericAgent& current,
@@ -54,7 +56,10 @@ private:
     double OptimalSpeed(const GenericAgent& ped, double spacing, double time_gap) const;
     double
     GetSpacing(const GenericAgent& ped1, const GenericAgent& ped2, const Point& direction) const;
-    Point BoundaryRepulsion(const GenericAgent& ped, const LineSegment& boundary_segment) const;
+    Point BoundaryRepulsion(const GenericAgent& ped, Point closestPoint) const;
+    Point BoundaryRepulsion(
+        const GenericAgent& ped,
+        const WallDistanceField::Sample& wallDistance) const;
 };
 
 template <>
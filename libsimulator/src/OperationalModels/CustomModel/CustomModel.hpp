@@ -115,7 +115,11 @@ public:
     CustomModel() = default;
     ~CustomModel() override = default;
 
-    OperationalModelType Type() const override { return OperationalModelType::CUSTOM_MODEL; }
+    OperationalModelType Type() const final { return OperationalModelType::CUSTOM_MODEL; }
+
+    /// Custom models are stepped serially unless they explicitly opt in. Models backed by Python
+    /// need the GIL for every step and cannot benefit from parallel execution.
+    bool SupportsParallelExecution() const override { return false; }
 };
 
 template <>
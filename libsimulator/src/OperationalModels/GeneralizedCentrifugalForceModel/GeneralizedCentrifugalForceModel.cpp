@@ -49,20 +49,18 @@ void GeneralizedCentrifugalForceModel::ComputeNextState(
     const NeighborhoodSearch<GenericAgent>& neighborhoodSearch) const
 {
     const auto& model = std::get<State>(current.model);
-    const auto neighborhood =
-        neighborhoodSearch.GetNeighboringAgents(model.position, _cutOffRadius);
     const auto p1 = model.position;
     Point F_rep;
-    for(const auto& neighbor : neighborhood) {
+    neighborhoodSearch.ForEachNeighborOf(current, _cutOffRadius, [&](const GenericAgent& neighbor) {
         // TODO(schroedtert): Only use neighbors who have an unobstructed line of sight to the
         // current agent
         if(neighbor.id == current.id) {
-            continue;
+            return;
         }
         if(!geometry.IntersectsAny(LineSegment(p1, std::get<State>(neighbor.model).position))) {
             F_rep += ForceRepPed(current, neighbor);
         }
-    }
+    });
 
     // e0 stays default constructed when ForceDriv does not overwrite it, matching the old
     // update struct semantics.
@@ -78,6 +76,7 @@ void GeneralizedCentrifugalForceModel::ComputeNextState(
     position = model.position + *velocity * dT;
 
     auto& nextModel = std::get<State>(next.model);
+    nextModel = model;
     nextModel.e0 = e0;
     ++nextModel.orientationDelay;
     if(position) {
@@ -135,10 +134,9 @@ void GeneralizedCentrifugalForceModel::CheckModelConstraint(
     constexpr double BMaxMax = 2.;
     validateConstraint(BMax, BMaxMin, BMaxMax, "BMax");
 
-    const auto neighbors = neighborhoodSearch.GetNeighboringAgents(model.position, 2);
-    for(const auto& neighbor : neighbors) {
+    neighborhoodSearch.ForEachNeighbor(model.position, 2, [&](const GenericAgent& neighbor) {
         if(agent.id == neighbor.id) {
-            continue;
+            return;
         }
 
         const auto& neighborModel = std::get<State>(neighbor.model);
@@ -155,7 +153,7 @@ void GeneralizedCentrifugalForceModel::CheckModelConstraint(
                 contanctDist,
                 distance - contanctDist);
         }
-    }
+    });
 
     const auto maxRadius = std::max(AMin, BMax) / 2.;
     const auto lineSegments = geometry.LineSegmentsInDistanceTo(maxRadius, model.position);
@@ -321,8 +319,8 @@ inline Point GeneralizedCentrifugalForceModel::ForceRepRoom(
         geometry.LineSegmentsInApproxDistanceTo(std::get<State>(ped.model).position);
 
     auto f = std::accumulate(
-        walls.cbegin(),
-        walls.cend(),
+        std::begin(walls),
+        std::end(walls),
         Point(0, 0),
         [this, &ped](const auto& acc, const auto& element) {
             return acc + ForceRepWall(ped, element);
@@ -8,7 +8,7 @@
 
 #include <fmt/core.h>
 
-class GeneralizedCentrifugalForceModel : public OperationalModel
+class GeneralizedCentrifugalForceModel final : public OperationalModel
 {
 public:
     /// Per-agent state of the generalized centrifugal force model.
@@ -51,6 +51,7 @@ public:
     ~GeneralizedCentrifugalForceModel() override = default;
 
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
     void ComputeNextState(
         double dT,
         const GenericAgent& current,
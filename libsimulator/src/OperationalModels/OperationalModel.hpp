@@ -57,9 +57,11 @@ public:
     virtual OperationalModelType Type() const = 0;
 
     /// Computes the agent state for the next iteration.
-    /// "next" arrives as an exact copy of "current"; implementations overwrite only the fields
-    /// they change. Other agents must be read exclusively from the frozen current generation,
-    /// i.e. via "current" and the neighborhood search, never via "next".
+    /// For custom models "next" arrives as an exact copy of "current"; implementations overwrite
+    /// only the fields they change. Built-in models get "next" with a model state left over from
+    /// an earlier iteration and write the complete model state. Other agents must be read
+    /// exclusively from the frozen current generation, i.e. via "current" and the neighborhood
+    /// search, never via "next".
     virtual void ComputeNextState(
         double dT,
         const GenericAgent& current,
@@ -71,4 +73,15 @@ public:
         const GenericAgent& agent,
         const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
         const CollisionGeometry& geometry) const = 0;
+
+    /// Largest radius the model passes to NeighborhoodSearch::ForEachNeighborOf() in
+    /// ComputeNextState(). Used to size the Verlet neighbor lists, 0 if the model does not support
+    /// them.
+    virtual double CutOffRadius() const { return 0.0; }
+
+    /// Whether ComputeNextState() may be called concurrently for different agents.
+    /// Models that mutate shared state during ComputeNextState() (e.g. a model-wide random
+    /// number generator) or depend on the agent iteration order must return false; they are
+    /// always stepped serially.
+    virtual bool SupportsParallelExecution() const { return true; }
 };
@@ -4,6 +4,7 @@
 #include "CollisionGeometry.hpp"
 #include "GenericAgent.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -11,8 +12,8 @@
 #include "SimulationError.hpp"
 
 #include <cmath>
+#include <cstddef>
 #include <iterator>
-#include <numeric>
 #include <string>
 
 SocialForceModel::SocialForceModel(double bodyForce, double friction)
@@ -35,29 +36,28 @@ void SocialForceModel::ComputeNextState(
     const auto& model = std::get<State>(current.model);
     auto forces = DrivingForce(current);
 
-    const auto neighborhood =
-        neighborhoodSearch.GetNeighboringAgents(model.position, this->_cutOffRadius);
     Point F_rep;
-    for(const auto& neighbor : neighborhood) {
-        if(neighbor.id == current.id) {
-            continue;
-        }
-        F_rep += AgentForce(current, neighbor);
-    }
-    forces += F_rep / model.mass;
-    const auto& walls = geometry.LineSegmentsInApproxDistanceTo(model.position);
-
-    const auto obstacle_f = std::accumulate(
-        walls.cbegin(),
-        walls.cend(),
-        Point(0, 0),
-        [this, &current](const auto& acc, const auto& element) {
-            return acc + ObstacleForce(current, element);
+    neighborhoodSearch.ForEachNeighborOf(
+        current, this->_cutOffRadius, [this, &current, &F_rep](const auto& neighbor) {
+            if(neighbor.id == current.id) {
+                return;
+            }
+            F_rep += AgentForce(current, neighbor);
         });
+    forces += F_rep / model.mass;
+    thread_local ClosestPoints closest{};
+    geometry.LineSegmentBlockInApproxDistanceTo(model.position)
+        .ClosestPointsTo(model.position, closest);
+
+    Point obstacle_f(0, 0);
+    for(size_t index = 0; index < closest.Size(); ++index) {
+        obstacle_f += ObstacleForce(current, closest.At(index));
+    }
     forces += obstacle_f / model.mass;
 
     const auto velocity = model.velocity + forces * dT;
     auto& nextModel = std::get<State>(next.model);
+    nextModel = model;
     nextModel.position = model.position + velocity * dT;
     nextModel.velocity = velocity;
 }
@@ -94,8 +94,7 @@ void SocialForceModel::CheckModelConstraint(
     const auto radius = model.radius;
     throwIfNegative(radius, "radius");
 
-    const auto neighbors = neighborhoodSearch.GetNeighboringAgents(model.position, 2);
-    for(const auto& neighbor : neighbors) {
+    neighborhoodSearch.ForEachNeighbor(model.position, 2, [&model](const auto& neighbor) {
         const auto& neighborPosition = std::get<State>(neighbor.model).position;
         const auto distance = (model.position - neighborPosition).Norm();
 
@@ -108,7 +107,7 @@ void SocialForceModel::CheckModelConstraint(
                 distance,
                 model.radius);
         }
-    }
+    });
     const auto maxRadius = model.radius / 2;
     const auto lineSegments = geometry.LineSegmentsInDistanceTo(maxRadius, model.position);
     if(std::begin(lineSegments) != std::end(lineSegments)) {
@@ -149,13 +148,12 @@ Point SocialForceModel::AgentForce(const GenericAgent& ped1, const GenericAgent&
         this->friction);
 };
 
-Point SocialForceModel::ObstacleForce(const GenericAgent& agent, const LineSegment& segment) const
+Point SocialForceModel::ObstacleForce(const GenericAgent& agent, Point closestPoint) const
 {
     const auto& model = std::get<State>(agent.model);
-    const Point pt = segment.ShortestPoint(model.position);
     return ForceBetweenPoints(
         model.position,
-        pt,
+        closestPoint,
         model.obstacleScale,
         model.forceDistance,
         model.radius,
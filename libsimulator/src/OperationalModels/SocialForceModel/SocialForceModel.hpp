@@ -9,7 +9,7 @@
 
 #include <fmt/core.h>
 
-class SocialForceModel : public OperationalModel
+class SocialForceModel final : public OperationalModel
 {
 public:
     /// Per-agent state of the social force model.
@@ -34,6 +34,7 @@ public:
     SocialForceModel(double bodyForce, double friction);
     ~SocialForceModel() override = default;
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
     void ComputeNextState(
         double dT,
         const GenericAgent& current,
@@ -61,12 +62,13 @@ private:
      */
     Point AgentForce(const GenericAgent& ped1, const GenericAgent& ped2) const;
     /**
-     *  Repulsive force acting on pedestrian <agent> from line segment <segment>
+     *  Repulsive force acting on pedestrian <agent> from a line segment
      * @param agent reference to the Pedestrian on whom the force acts on
-     * @param segment reference to line segment, from which the force originates
+     * @param closestPoint point on the line segment closest to <agent>, from which the force
+     * originates
      * @return vector with the repulsive force
      */
-    Point ObstacleForce(const GenericAgent& agent, const LineSegment& segment) const;
+    Point ObstacleForce(const GenericAgent& agent, Point closestPoint) const;
     /**
      * calculates the pushing and friction forces acting between <pt1> and <pt2>
      * @param pt1 Point on which the forces act
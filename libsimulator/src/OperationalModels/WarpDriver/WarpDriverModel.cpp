@@ -27,6 +27,7 @@
 //
 #include "WarpDriverModel.hpp"
 
+#include "CounterBasedRng.hpp"
 #include "GenericAgent.hpp"
 #include "NeighborhoodSearch.hpp"
 #include "OperationalModelType.hpp"
@@ -35,6 +36,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <random>
 #include <variant>
 
 // ============================================================================
@@ -337,7 +339,7 @@ WarpDriverModel::WarpDriverModel(
     // 2 * v_max * timeHorizon, plus their combined radii, plus a small margin.
     // v_max and r_max are hardcoded pedestrian defaults.
     , _cutOffRadius(2.0 * 1.5 * timeHorizon + 2.0 * 0.3 + 0.5)
-    , _rng(rngSeed)
+    , _rngSeed(rngSeed)
 {
     if(sigma <= 0.0) {
         throw SimulationError("WarpDriverModel: sigma must be > 0, got {}", sigma);
@@ -421,7 +423,10 @@ void WarpDriverModel::ComputeNextState(
 {
     const auto& agentData = std::get<State>(current.model);
     auto& nextData = std::get<State>(next.model);
+    nextData = agentData;
     const double speed = agentData.v0;
+    CounterBasedRng rng(_rngSeed, current.id.getID(), agentData.rngCounter);
+    nextData.rngCounter = agentData.rngCounter + 1;
 
     // State orientation (unit vector). If zero, default to +x.
     Point orient = agentData.orientation;
@@ -456,8 +461,11 @@ void WarpDriverModel::ComputeNextState(
     const double dtSample = this->_timeHorizon / std::max(this->_numSamples - 1, 1);
 
     // === Step 2: Perceive - build collision probability field ===
-    const auto neighbors =
-        neighborhoodSearch.GetNeighboringAgents(agentData.position, _cutOffRadius);
+    thread_local std::vector<const GenericAgent*> neighbors{};
+    neighbors.clear();
+    neighborhoodSearch.ForEachNeighborOf(current, _cutOffRadius, [](const GenericAgent& neighbor) {
+        neighbors.push_back(&neighbor);
+    });
 
     // Short-range repulsion: not part of the original Wolinski et al. (2016)
     // model, which is purely anticipatory. Added as a practical safety net
@@ -465,11 +473,11 @@ void WarpDriverModel::ComputeNextState(
     // when agents are already close (dense crowds, late reactions).
     // Similar to the pushout mechanisms in CFS and AVM.
     Point repulsion{0.0, 0.0};
-    for(const auto& neighbor : neighbors) {
-        if(neighbor.id == current.id) {
+    for(const auto* neighbor : neighbors) {
+        if(neighbor->id == current.id) {
             continue;
         }
-        const auto* nbData = std::get_if<State>(&neighbor.model);
+        const auto* nbData = std::get_if<State>(&neighbor->model);
         if(!nbData) {
             continue;
         }
@@ -500,17 +508,17 @@ void WarpDriverModel::ComputeNextState(
 
     for(int i = 0; i < this->_numSamples; ++i) {
         const double t = i * dtSample;
-        const double lateralPerturbation = perturbDist(_rng);
+        const double lateralPerturbation = perturbDist(rng);
         samples[static_cast<size_t>(i)] =
             Sample{t, STP{speed * t, lateralPerturbation, t}, 0.0, STP{0, 0, 0}};
     }
 
-    for(const auto& neighbor : neighbors) {
-        if(neighbor.id == current.id) {
+    for(const auto* neighbor : neighbors) {
+        if(neighbor->id == current.id) {
             continue;
         }
 
-        const auto* nbData = std::get_if<State>(&neighbor.model);
+        const auto* nbData = std::get_if<State>(&neighbor->model);
         if(!nbData) {
             continue;
         }
@@ -724,7 +732,7 @@ void WarpDriverModel::ComputeNextState(
     } else if(stuckTime >= stuckThreshold) {
         // Stuck: no net progress for stuckThreshold seconds — enter detour
         std::uniform_int_distribution<int> sideDist(0, 1);
-        detourSide = sideDist(_rng) * 2 - 1; // -1 or +1
+        detourSide = sideDist(rng) * 2 - 1; // -1 or +1
         detourTime = detourDuration;
         stuckTime = 0.0;
     }
@@ -9,11 +9,10 @@
 #include <fmt/core.h>
 
 #include <cstdint>
-#include <random>
 #include <utility>
 #include <vector>
 
-class WarpDriverModel : public OperationalModel
+class WarpDriverModel final : public OperationalModel
 {
 public:
     /// Per-agent state of the warp driver model.
@@ -27,6 +26,7 @@ public:
         double anchorY{0.0};
         double detourTime{0.0}; // remaining time in detour mode
         int detourSide{1}; // +1 = left, -1 = right of desired direction
+        uint64_t rngCounter{0}; // steps taken, selects the agent's random numbers per step
     };
 
     /// 3-component space-time point/vector used internally
@@ -68,7 +68,7 @@ private:
     double _cutOffRadius;
 
     IntrinsicField _intrinsicField;
-    mutable std::mt19937 _rng;
+    uint64_t _rngSeed;
 
 public:
     WarpDriverModel(
@@ -84,6 +84,7 @@ public:
     ~WarpDriverModel() override = default;
 
     OperationalModelType Type() const override;
+    double CutOffRadius() const override { return _cutOffRadius; }
 
     void ComputeNextState(
         double dT,
@@ -0,0 +1,364 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "Polyanya.hpp"
+
+#include "Mesh.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+
+#include <glm/ext/vector_double2.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Paths to a root vertex that are longer by less than this are not pruned, they differ only by
+/// rounding errors.
+constexpr double RootPruningTolerance{1e-9};
+
+/// Positive if 'p' is left of the ray from 'origin' through 'through'.
+double orient(glm::dvec2 origin, glm::dvec2 through, glm::dvec2 p)
+{
+    const auto a = through - origin;
+    const auto b = p - origin;
+    return a.x * b.y - a.y * b.x;
+}
+
+/// Point where the ray from 'origin' through 'through' crosses the segment from 'a' to 'b'.
+/// Results are snapped to the end points of the segment.
+glm::dvec2 rayIntersection(glm::dvec2 origin, glm::dvec2 through, glm::dvec2 a, glm::dvec2 b)
+{
+    const auto direction = through - origin;
+    const auto edge = b - a;
+    const auto denominator = direction.x * edge.y - direction.y * edge.x;
+    if(denominator == 0.0) {
+        return a;
+    }
+    const auto toOrigin = origin - a;
+    const auto t = (direction.x * toOrigin.y - direction.y * toOrigin.x) / denominator;
+    if(t <= 0.0) {
+        return a;
+    }
+    if(t >= 1.0) {
+        return b;
+    }
+    return a + edge * t;
+}
+
+/// Lower bound of the length of a path from 'root' through the interval to 'target'.
+double heuristic(glm::dvec2 root, glm::dvec2 right, glm::dvec2 left, glm::dvec2 target)
+{
+    if(root == right || root == left || orient(root, right, left) <= 0.0) {
+        return glm::distance(root, target);
+    }
+    // Targets on the side of the root are mirrored, paths to them have to pass the interval
+    if(orient(right, left, target) > 0.0) {
+        const auto edge = left - right;
+        const auto foot = right + edge * (glm::dot(target - right, edge) / glm::dot(edge, edge));
+        target = foot + (foot - target);
+    }
+    if(orient(root, right, target) < 0.0) {
+        return glm::distance(root, right) + glm::distance(right, target);
+    }
+    if(orient(root, left, target) > 0.0) {
+        return glm::distance(root, left) + glm::distance(left, target);
+    }
+    return glm::distance(root, target);
+}
+} // namespace
+
+Polyanya::Polyanya(Mesh mesh_) : mesh(std::move(mesh_)), corners(mesh.CountVertices(), false)
+{
+    for(size_t index = 0; index < mesh.CountPolygons(); ++index) {
+        const auto& polygon = mesh.Polygons(index);
+        const auto count = polygon.vertices.size();
+        for(size_t edge = 0; edge < count; ++edge) {
+            if(polygon.neighbors[edge] == Mesh::Polygon::InvalidIndex) {
+                corners[polygon.vertices[edge]] = true;
+                corners[polygon.vertices[(edge + 1) % count]] = true;
+            }
+        }
+    }
+}
+
+std::vector<Point> Polyanya::ComputeAllWaypoints(Point from, Point to)
+{
+    const glm::dvec2 start{from.x, from.y};
+    const glm::dvec2 target{to.x, to.y};
+    const auto startPolygon = mesh.FindContainingPolygon(start);
+    if(startPolygon == Mesh::Polygon::InvalidIndex) {
+        throw SimulationError("Point ({}, {}) is outside of accessible area", from.x, from.y);
+    }
+    const auto targetPolygon = mesh.FindContainingPolygon(target);
+    if(targetPolygon == Mesh::Polygon::InvalidIndex) {
+        throw SimulationError("Point ({}, {}) is outside of accessible area", to.x, to.y);
+    }
+
+    lastSearchExpansions = 0;
+    if(startPolygon == targetPolygon) {
+        return {from, to};
+    }
+
+    nodes.clear();
+    rootDistances.assign(mesh.CountVertices(), std::numeric_limits<double>::infinity());
+    OpenList open{};
+
+    // The start sees all edges of its polygon
+    const auto& polygon = mesh.Polygons(startPolygon);
+    const auto count = polygon.vertices.size();
+    for(size_t edge = 0; edge < count; ++edge) {
+        const auto neighbor = polygon.neighbors[edge];
+        const auto rightVertex = polygon.vertices[edge];
+        const auto leftVertex = polygon.vertices[(edge + 1) % count];
+        pushSuccessor(
+            Mesh::InvalidIndex,
+            {Mesh::InvalidIndex,
+             start,
+             Mesh::InvalidIndex,
+             mesh.Vertex(rightVertex),
+             mesh.Vertex(leftVertex),
+             rightVertex,
+             leftVertex,
+             neighbor,
+             0.0,
+             0.0},
+            target,
+            open);
+    }
+
+    while(!open.empty()) {
+        const auto index = open.top().second;
+        open.pop();
+        if(nodes[index].polygon == Mesh::Polygon::InvalidIndex) {
+            std::vector<Point> waypoints{to};
+            for(auto pivot = index; pivot != Mesh::InvalidIndex; pivot = nodes[pivot].parent) {
+                const Point root{nodes[pivot].root.x, nodes[pivot].root.y};
+                if(root != waypoints.back()) {
+                    waypoints.push_back(root);
+                }
+            }
+            // The start is not kept if it had to move along an edge first
+            if(waypoints.back() != from) {
+                waypoints.push_back(from);
+            }
+            std::reverse(std::begin(waypoints), std::end(waypoints));
+            return waypoints;
+        }
+        ++lastSearchExpansions;
+        expand(index, target, targetPolygon, open);
+    }
+
+    throw SimulationError(
+        "Destination ({}, {}) cannot be reached from ({}, {})", to.x, to.y, from.x, from.y);
+}
+
+void Polyanya::expand(size_t index, glm::dvec2 target, size_t targetPolygon, OpenList& open)
+{
+    // Copied because pushing successors grows 'nodes'
+    const auto node = nodes[index];
+    const auto& polygon = mesh.Polygons(node.polygon);
+    const auto count = polygon.vertices.size();
+
+    // Seen from inside 'polygon' the interval's edge runs from its left to its right vertex
+    size_t entry = 0;
+    while(polygon.vertices[entry] != node.leftVertex ||
+          polygon.vertices[(entry + 1) % count] != node.rightVertex) {
+        if(++entry == count) {
+            throw SimulationError("Internal Error");
+        }
+    }
+
+    const auto root = node.root;
+    // A root on the line of the interval is on the boundary of the polygon and sees all of it
+    const bool rootOnInterval =
+        root == node.right || root == node.left || orient(root, node.right, node.left) <= 0.0;
+
+    if(node.polygon == targetPolygon) {
+        auto last = node;
+        last.parent = index;
+        last.polygon = Mesh::Polygon::InvalidIndex;
+        if(!rootOnInterval && orient(root, node.right, target) < 0.0) {
+            last.root = node.right;
+            last.rootVertex = node.rightVertex;
+            last.g += glm::distance(root, node.right);
+        } else if(!rootOnInterval && orient(root, node.left, target) > 0.0) {
+            last.root = node.left;
+            last.rootVertex = node.leftVertex;
+            last.g += glm::distance(root, node.left);
+        }
+        push(last, target, open);
+        return;
+    }
+
+    // Edges other than the entry edge ordered from right to left as seen from the root
+    const auto edges = count - 1;
+    const auto vertexAt = [&polygon, entry, count](size_t offset) {
+        return polygon.vertices[(entry + 1 + offset) % count];
+    };
+    const auto pointAt = [this, &vertexAt](size_t offset) { return mesh.Vertex(vertexAt(offset)); };
+    const auto successor = [&](glm::dvec2 successorRoot,
+                               size_t successorRootVertex,
+                               double g,
+                               size_t edge,
+                               glm::dvec2 right,
+                               glm::dvec2 left) {
+        pushSuccessor(
+            index,
+            {index,
+             successorRoot,
+             successorRootVertex,
+             right,
+             left,
+             vertexAt(edge),
+             vertexAt(edge + 1),
+             polygon.neighbors[(entry + 1 + edge) % count],
+             g,
+             0.0},
+            target,
+            open);
+    };
+
+    if(rootOnInterval) {
+        for(size_t edge = 0; edge < edges; ++edge) {
+            successor(root, node.rootVertex, node.g, edge, pointAt(edge), pointAt(edge + 1));
+        }
+        return;
+    }
+
+    // Edges crossed by the rays from the root through the ends of the interval, edges on a ray
+    // count as visible
+    size_t rightEdge = edges - 1;
+    for(size_t edge = 0; edge < edges; ++edge) {
+        if(orient(root, node.right, pointAt(edge + 1)) >= 0.0) {
+            rightEdge = edge;
+            break;
+        }
+    }
+    size_t leftEdge = edges - 1;
+    for(size_t edge = rightEdge; edge < edges; ++edge) {
+        if(orient(root, node.left, pointAt(edge + 1)) > 0.0) {
+            leftEdge = edge;
+            break;
+        }
+    }
+    const auto rightPoint =
+        rayIntersection(root, node.right, pointAt(rightEdge), pointAt(rightEdge + 1));
+    const auto leftPoint =
+        rayIntersection(root, node.left, pointAt(leftEdge), pointAt(leftEdge + 1));
+
+    // Everything between the rays is visible from the root
+    for(size_t edge = rightEdge; edge <= leftEdge; ++edge) {
+        successor(
+            root,
+            node.rootVertex,
+            node.g,
+            edge,
+            edge == rightEdge ? rightPoint : pointAt(edge),
+            edge == leftEdge ? leftPoint : pointAt(edge + 1));
+    }
+
+    // Everything outside of the rays is only reachable by turning around an end of the interval,
+    // which requires the end to be a corner of the walkable area
+    const auto turnAround = [&](size_t vertex) {
+        const auto g = node.g + glm::distance(root, mesh.Vertex(vertex));
+        if(!corners[vertex] || !improvesRoot(vertex, g)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return g;
+    };
+    if(node.right == pointAt(0)) {
+        if(const auto g = turnAround(vertexAt(0)); g != std::numeric_limits<double>::infinity()) {
+            for(size_t edge = 0; edge <= rightEdge; ++edge) {
+                successor(
+                    pointAt(0),
+                    vertexAt(0),
+                    g,
+                    edge,
+                    pointAt(edge),
+                    edge == rightEdge ? rightPoint : pointAt(edge + 1));
+            }
+        }
+    }
+    if(node.left == pointAt(edges)) {
+        if(const auto g = turnAround(vertexAt(edges));
+           g != std::numeric_limits<double>::infinity()) {
+            for(size_t edge = leftEdge; edge < edges; ++edge) {
+                successor(
+                    pointAt(edges),
+                    vertexAt(edges),
+                    g,
+                    edge,
+                    edge == leftEdge ? leftPoint : pointAt(edge),
+                    pointAt(edge + 1));
+            }
+        }
+    }
+}
+
+void Polyanya::pushSuccessor(size_t parent, Node node, glm::dvec2 target, OpenList& open)
+{
+    if(node.polygon == Mesh::Polygon::InvalidIndex || node.right == node.left) {
+        return;
+    }
+    if(node.root == node.right || node.root == node.left) {
+        // Polygons around the root are entered one after another, stop once the fan closes
+        for(auto pivot = parent; pivot != Mesh::InvalidIndex && nodes[pivot].root == node.root;
+            pivot = nodes[pivot].parent) {
+            if(nodes[pivot].polygon == node.polygon) {
+                return;
+            }
+        }
+    } else if(
+        orient(node.root, node.right, node.left) <= 0.0 &&
+        glm::dot(node.right - node.root, node.left - node.root) > 0.0) {
+        // Intervals in line with the root are passed by moving along the line to their closer
+        // end, the path continues from there
+        const bool rightIsCloser =
+            glm::distance(node.root, node.right) <= glm::distance(node.root, node.left);
+        const auto closer = rightIsCloser ? node.right : node.left;
+        const auto closerVertex = rightIsCloser ? node.rightVertex : node.leftVertex;
+        const auto closerG = node.g + glm::distance(node.root, closer);
+        const bool closerIsVertex = closer == mesh.Vertex(closerVertex);
+        if(closerIsVertex && !improvesRoot(closerVertex, closerG)) {
+            return;
+        }
+        if(parent != Mesh::InvalidIndex && node.root != nodes[parent].root) {
+            // Keeps the turn at the end of the expanded interval in the path, this node is
+            // never expanded
+            auto turn = nodes[parent];
+            turn.parent = parent;
+            turn.root = node.root;
+            turn.rootVertex = node.rootVertex;
+            nodes.push_back(turn);
+            node.parent = nodes.size() - 1;
+        }
+        node.g = closerG;
+        node.root = closer;
+        node.rootVertex = closerIsVertex ? closerVertex : Mesh::InvalidIndex;
+    }
+    push(node, target, open);
+}
+
+bool Polyanya::improvesRoot(size_t vertex, double g)
+{
+    if(g > rootDistances[vertex] + RootPruningTolerance) {
+        return false;
+    }
+    rootDistances[vertex] = std::min(rootDistances[vertex], g);
+    return true;
+}
+
+void Polyanya::push(Node node, glm::dvec2 target, OpenList& open)
+{
+    if(node.polygon == Mesh::Polygon::InvalidIndex) {
+        node.f = node.g + glm::distance(node.root, target);
+    } else {
+        node.f = node.g + heuristic(node.root, node.right, node.left, target);
+    }
+    nodes.push_back(node);
+    open.emplace(node.f, nodes.size() - 1);
+}
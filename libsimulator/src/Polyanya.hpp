@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "Mesh.hpp"
+#include "Point.hpp"
+
+#include <glm/ext/vector_double2.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/// Optimal any-angle shortest path search on a mesh of convex polygons.
+///
+/// Implements "Compromise-free Pathfinding on a Navigation Mesh" (Cui, Harabor, Grastien 2017).
+/// A search node is an interval on a polygon edge together with the last turning point (root)
+/// of the path to it. Expanding a node projects the interval through the polygon behind it.
+/// Paths only turn at vertices on the boundary of the walkable area.
+class Polyanya
+{
+    struct Node {
+        size_t parent{};
+        /// Last turning point of the path, either the start or a mesh vertex.
+        glm::dvec2 root{};
+        size_t rootVertex{};
+        /// Interval as seen from 'root', it lies on the edge from 'rightVertex' to 'leftVertex'.
+        glm::dvec2 right{};
+        glm::dvec2 left{};
+        size_t rightVertex{};
+        size_t leftVertex{};
+        /// Polygon entered through the interval, invalid for nodes reaching the destination.
+        size_t polygon{};
+        /// Length of the path to 'root'.
+        double g{};
+        double f{};
+    };
+
+    /// Nodes to expand as pairs of f-value and index into 'nodes'.
+    using OpenList = std::priority_queue<
+        std::pair<double, size_t>,
+        std::vector<std::pair<double, size_t>>,
+        std::greater<>>;
+
+    Mesh mesh;
+    /// Vertices on the boundary of the walkable area, only they can be turning points.
+    std::vector<bool> corners{};
+    std::vector<Node> nodes{};
+    /// Shortest path found to each vertex in the current search.
+    std::vector<double> rootDistances{};
+    size_t lastSearchExpansions{};
+
+public:
+    /// @param mesh convex polygons in CCW orientation, e.g. after 'Mesh::MergeGreedy'
+    explicit Polyanya(Mesh mesh);
+    ~Polyanya() = default;
+    Polyanya(const Polyanya& other) = delete;
+    Polyanya& operator=(const Polyanya& other) = delete;
+    Polyanya(Polyanya&& other) = default;
+    Polyanya& operator=(Polyanya&& other) = default;
+
+    /// Computes the shortest path including 'from' and 'to'.
+    /// @throws SimulationError if a point is outside of the mesh or 'to' cannot be reached
+    std::vector<Point> ComputeAllWaypoints(Point from, Point to);
+    /// Number of nodes expanded by the last query.
+    size_t LastSearchExpansions() const { return lastSearchExpansions; }
+    const Mesh& MeshData() const { return mesh; }
+
+private:
+    void expand(size_t index, glm::dvec2 target, size_t targetPolygon, OpenList& open);
+    /// Pushes a node unless its interval is empty or leads out of the mesh.
+    void pushSuccessor(size_t parent, Node node, glm::dvec2 target, OpenList& open);
+    /// Paths turning at a vertex are only followed if they are the shortest to it found so far.
+    bool improvesRoot(size_t vertex, double g);
+    void push(Node node, glm::dvec2 target, OpenList& open);
+};
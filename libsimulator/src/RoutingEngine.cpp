@@ -6,7 +6,9 @@
 #include "LineSegment.hpp"
 #include "Mesh.hpp"
 #include "Point.hpp"
+#include "Polyanya.hpp"
 #include "SimulationError.hpp"
+#include "Tracing.hpp"
 
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
 #include <CGAL/Distance_2/Point_2_Segment_2.h>
@@ -16,9 +18,10 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <deque>
+#include <functional>
 #include <limits>
-#include <unordered_map>
+#include <memory>
+#include <queue>
 #include <utility>
 #include <vector>
 
@@ -38,61 +41,96 @@ RoutingEngine::RoutingEngine(const PolyWithHoles& poly)
     }
     CGAL::mark_domain_in_triangulation(cdt);
     mesh = std::make_unique<Mesh>(cdt);
+    indexFaces();
 }
 
-Point RoutingEngine::ComputeWaypoint(Point currentPosition, Point destination)
+RoutingEngine::RoutingEngine(CDT&& triangulation, std::unique_ptr<Mesh> mesh_)
+    : cdt(std::move(triangulation)), mesh(std::move(mesh_))
 {
-    return ComputeAllWaypoints(currentPosition, destination)[1];
+    indexFaces();
 }
 
-struct SearchState {
-    double g_value{};
-    double h_value{};
-    CDT::Face_handle id{};
-    SearchState* parent{};
+[[noreturn]] static void throwUnreachable(Point from, Point destination)
+{
+    throw SimulationError(
+        "Destination ({}, {}) cannot be reached from ({}, {})",
+        destination.x,
+        destination.y,
+        from.x,
+        from.y);
+}
 
-    SearchState(double g, double h, CDT::Face_handle _id, SearchState* _parent)
-        : g_value(g), h_value(h), id(_id), parent(_parent)
-    {
+Point RoutingEngine::ComputeWaypoint(Point currentPosition, Point destination)
+{
+    const auto from = find_face({currentPosition.x, currentPosition.y});
+    const auto& tree = destinationTree(destination, from->get_index());
+    if(from->get_index() == tree.destinationFace) {
+        return destination;
+    }
+    if(tree.next[from->get_index()] == InvalidIndex) {
+        throwUnreachable(currentPosition, destination);
     }
 
-    double f_value() const { return g_value + h_value; }
-    bool parents_contain(CDT::Face_handle ancestor_id) const
-    {
-        const SearchState* pivot = this;
-        while(pivot != nullptr) {
-            if(pivot->id == ancestor_id) {
-                return true;
+    // The corridor is extended along the tree only as far as the funnel needs to find the next
+    // corner, which is usually a few faces.
+    corridor.clear();
+    corridor.push_back(from);
+    const auto faceAt = [this, &tree](size_t index) {
+        while(corridor.size() <= index) {
+            const auto next = tree.next[corridor.back()->get_index()];
+            if(next == InvalidIndex) {
+                return CDT::Face_handle{};
             }
-            pivot = pivot->parent;
+            corridor.push_back(faces[next]);
         }
-        return false;
+        return corridor[index];
+    };
+    return funnel(currentPosition, destination, faceAt, 2)[1];
+}
+
+RoutingEngine::Route
+RoutingEngine::ComputeRoute(Point currentPosition, Point destination, size_t faceHint)
+{
+    const auto from = find_face({currentPosition.x, currentPosition.y}, faceHint);
+    const auto& tree = destinationTree(destination, from->get_index());
+    Route route{};
+    route.corridor.push_back(from->get_index());
+    while(tree.next[route.corridor.back()] != InvalidIndex) {
+        route.corridor.push_back(tree.next[route.corridor.back()]);
     }
-    std::vector<CDT::Face_handle> path() const
-    {
-        std::vector<CDT::Face_handle> p{};
-        p.reserve(16);
-        const SearchState* pivot = this;
-        while(pivot != nullptr) {
-            p.emplace_back(pivot->id);
-            pivot = pivot->parent;
-        }
-        std::reverse(std::begin(p), std::end(p));
-        return p;
+    if(route.corridor.back() != tree.destinationFace) {
+        throwUnreachable(currentPosition, destination);
     }
-};
 
-struct FaceHandleHash {
-    std::size_t operator()(CDT::Face_handle fh) const noexcept
-    {
-        // Face_handle is an iterator, therefore use "&*"-pattern to get the address.
-        return std::hash<decltype(&*fh)>{}(&*fh);
-    }
-};
+    const auto& corridorFaces = route.corridor;
+    route.waypoints = funnel(
+        currentPosition,
+        destination,
+        [this, &corridorFaces](size_t index) {
+            return index < corridorFaces.size() ? faces[corridorFaces[index]] :
+                                                  CDT::Face_handle{};
+        },
+        std::numeric_limits<size_t>::max(),
+        &route.passedAt);
+    route.waypoints.erase(std::begin(route.waypoints));
+    route.passedAt.push_back(route.corridor.size());
+    return route;
+}
 
-bool CompareSearchStatesGt(const SearchState* a, const SearchState* b)
+bool RoutingEngine::FaceContains(size_t face, Point p) const
 {
-    return a->f_value() > b->f_value();
+    const auto handle = faces[face];
+    for(int idx = 0; idx < 3; ++idx) {
+        const auto a = handle->vertex(idx)->point();
+        const auto b = handle->vertex(CDT::ccw(idx))->point();
+        const Point edge{CGAL::to_double(b.x() - a.x()), CGAL::to_double(b.y() - a.y())};
+        const Point toP{p.x - CGAL::to_double(a.x()), p.y - CGAL::to_double(a.y())};
+        // Faces are counterclockwise, points right of an edge are outside
+        if(edge.CrossProduct(toP) < 0) {
+            return false;
+        }
+    }
+    return true;
 }
 
 double length_of_path(const std::vector<Point>& path)
@@ -106,63 +144,66 @@ double length_of_path(const std::vector<Point>& path)
 
 std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Point destination)
 {
+    if(algorithm == RoutingAlgorithm::Polyanya) {
+        return computeAllWaypointsPolyanya(currentPosition, destination);
+    }
     const auto from_pos = CDT::Point{currentPosition.x, currentPosition.y};
     const auto to_pos = CDT::Point{destination.x, destination.y};
     const auto from = find_face(from_pos);
     const auto to = find_face(to_pos);
 
+    lastSearchExpansions = 0;
     if(from == to) {
         return std::vector<Point>{currentPosition, destination};
     }
 
-    // Hold all search states inside a deque which never invalidates pointers and grows within O(1)
-    std::deque<SearchState> all_search_states{};
-    std::vector<SearchState*> open_states{};
-    all_search_states.emplace_back(0.0, Distance(currentPosition, destination), from, nullptr);
-    open_states.push_back(&all_search_states.back());
-
-    std::unordered_map<CDT::Face_handle, SearchState*, FaceHandleHash> closed_states{};
+    // Bumping the generation invalidates the state of all faces from the previous query
+    ++searchGeneration;
+    openList.clear();
+    const auto from_index = from->get_index();
+    searchNodes[from_index] = {
+        searchGeneration, 0.0, Distance(currentPosition, destination), InvalidIndex, InvalidIndex};
+    openPush(from_index);
 
     std::vector<Point> path{};
     double path_length = std::numeric_limits<double>::infinity();
 
-    while(!open_states.empty()) {
-        std::pop_heap(open_states.begin(), open_states.end(), CompareSearchStatesGt);
-        SearchState* current_state = open_states.back();
-        open_states.pop_back();
-        closed_states.emplace(current_state->id, current_state);
+    while(!openList.empty()) {
+        const auto current = openPop();
+        const auto& current_state = searchNodes[current];
+        ++lastSearchExpansions;
 
-        if(current_state->f_value() >= path_length) {
+        if(current_state.f() >= path_length) {
             // This search node's f-value already exceeds our path's length, and since the f-value
             // is underestimation of the path length the exact path cannot be shorter than what we
             // have
-            return path;
+            break;
         }
 
         // Generate successors
         for(int idx = 0; idx < 3; ++idx) {
-            const auto target = current_state->id->neighbor(idx);
+            const auto target = faces[current]->neighbor(idx);
             if(!target->get_in_domain()) {
                 // Not a neighboring triangle.
                 continue;
             }
-            // Do not add search nodes for nodes already in the ancestor list of this path
-            if(current_state->parents_contain(target)) {
-                continue;
-            }
+            const auto target_index = target->get_index();
+            auto& target_state = searchNodes[target_index];
+            const bool discovered = target_state.generation == searchGeneration;
 
-            // Skip successors for nodes already in the closed list
-            if(closed_states.contains(target)) {
+            // Skip successors for nodes already in the closed list, this includes all ancestors
+            // of the current node
+            if(discovered && target_state.openPosition == InvalidIndex) {
                 continue;
             }
 
-            // The shared edge between `current_state->id` and `target` is the edge
+            // The shared edge between `current` and `target` is the edge
             // opposite vertex `idx` of the CURRENT face. CGAL's neighbor indexing is
             // not symmetric: the index of `target` in current's neighbor list differs
             // from the index of `current` in target's neighbor list, so querying
             // `cdt.segment(target, idx)` returns an unrelated edge of `target` and
             // produces bogus g/h values that mis-rank successors in A*.
-            const auto edge = cdt.segment(current_state->id, idx);
+            const auto edge = cdt.segment(faces[current], idx);
 
             // For all remaining nodes compute g/h values
             // The h-value is the distance between the goal and the closest point on the edge
@@ -186,20 +227,20 @@ std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Poi
             // by these edges. Thus, if the entry edges of the triangles corresponding to s′ and
             // s form an angle θ, this estimate is calculated as g(s) + rθ. NOTE: Right now this
             // is always g(s) + zero as we assume point size agents (for now)
-            const double g_value_2 = current_state->g_value + 0;
+            const double g_value_2 = current_state.g + 0;
 
             //  Another lower bound value for g(s′) is g(s)+(h(s)−h(s′)), or the parent state’s
             //  g-value plus the difference between its h-value and that of the child state.
             //  This is an underestimate because the Euclidean distance metric used for the
             //  heuristic is consistent.
-            const double g_value_3 = current_state->g_value + current_state->h_value - h_value;
+            const double g_value_3 = current_state.g + current_state.h - h_value;
 
             const double g_value = std::max(g_value_1, std::max(g_value_2, g_value_3));
 
             // Evaluate every route that reaches the destination inline so that all
             // candidate routes have their funnel computed — not just the first one
-            // (minimum-f_value) to arrive.  The closed_states guard would otherwise
-            // block all subsequent routes from being evaluated.
+            // (minimum-f_value) to arrive. The destination therefore never enters the open
+            // list.
             if(target == to) {
                 // g_value + h_value is f_value which is a lower bound and therefore needs
                 // to be smaller than current path length to be a good candidate.
@@ -207,10 +248,15 @@ std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Poi
                     // Unlike in A* this is only a first candidate solution
                     // Now compute the actual path length via funnel algorithm
                     // store path and length if this variant is the shortest found so far
-                    const SearchState dest_state{g_value, h_value, to, current_state};
-                    const auto vertex_ids = dest_state.path();
+                    searchPath.clear();
+                    searchPath.push_back(to);
+                    for(auto pivot = current; pivot != InvalidIndex;
+                        pivot = searchNodes[pivot].parent) {
+                        searchPath.push_back(faces[pivot]);
+                    }
+                    std::reverse(std::begin(searchPath), std::end(searchPath));
                     const auto found_path =
-                        straightenPath(currentPosition, destination, vertex_ids);
+                        straightenPath(currentPosition, destination, searchPath);
                     const double found_path_length = length_of_path(found_path);
                     if(found_path_length < path_length) {
                         path = found_path;
@@ -220,45 +266,96 @@ std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Poi
                 continue;
             }
 
-            // NOTE(kkratz): Clang16 seems to be confused with capturing a structured binding
-            // and emits a warning when capturing 'target' directly. As of C++20 this SHOULD(TM)
-            // be valid code but see:
-            // https://stackoverflow.com/questions/46114214/lambda-implicit-capture-fails-with-variable-declared-from-structured-binding
-            auto t2 = target;
-
-            // TODO(kkratz): replace this find on unsorted vector with something with a better
-            // runtime
-            if(auto iter = std::find_if(
-                   std::begin(open_states),
-                   std::end(open_states),
-                   [t2](const auto& s) { return s->id == t2; });
-               iter != std::end(open_states)) {
-                if(auto* s = *iter; s->g_value > g_value) {
-                    s->g_value = g_value;
-                    s->parent = current_state;
-                    // As the g_value got modified, the heap needs to be entirely remade.
-                    std::make_heap(open_states.begin(), open_states.end(), CompareSearchStatesGt);
-                }
-            } else if(auto iter = closed_states.find(target); iter != closed_states.end()) {
-                auto* s = iter->second;
-                if(s->g_value > g_value) {
-                    s->g_value = g_value;
-                    s->parent = current_state;
-                    open_states.push_back(s);
-                    std::push_heap(open_states.begin(), open_states.end(), CompareSearchStatesGt);
-                    closed_states.erase(s->id);
-                }
-            } else {
-                all_search_states.emplace_back(g_value, h_value, target, current_state);
-                open_states.push_back(&all_search_states.back());
-                std::push_heap(open_states.begin(), open_states.end(), CompareSearchStatesGt);
+            if(!discovered) {
+                target_state = {searchGeneration, g_value, h_value, current, InvalidIndex};
+                openPush(target_index);
+            } else if(target_state.g > g_value) {
+                target_state.g = g_value;
+                target_state.parent = current;
+                openSiftUp(target_state.openPosition);
             }
         }
     }
 
+    JPS_TRACE_COUNTER("Route Search Expansions", lastSearchExpansions);
     return path;
 }
 
+std::vector<Point>
+RoutingEngine::computeAllWaypointsPolyanya(Point currentPosition, Point destination)
+{
+    if(!polyanya) {
+        Mesh merged = *mesh;
+        merged.MergeGreedy();
+        polyanya = std::make_unique<Polyanya>(std::move(merged));
+    }
+    auto path = polyanya->ComputeAllWaypoints(currentPosition, destination);
+    lastSearchExpansions = polyanya->LastSearchExpansions();
+    JPS_TRACE_COUNTER("Route Search Expansions", lastSearchExpansions);
+    return path;
+}
+
+void RoutingEngine::openPush(size_t face)
+{
+    searchNodes[face].openPosition = openList.size();
+    openList.push_back(face);
+    openSiftUp(openList.size() - 1);
+}
+
+size_t RoutingEngine::openPop()
+{
+    const auto top = openList.front();
+    openList.front() = openList.back();
+    searchNodes[openList.front()].openPosition = 0;
+    openList.pop_back();
+    if(!openList.empty()) {
+        openSiftDown(0);
+    }
+    searchNodes[top].openPosition = InvalidIndex;
+    return top;
+}
+
+void RoutingEngine::openSiftUp(size_t position)
+{
+    const auto face = openList[position];
+    const auto f = searchNodes[face].f();
+    while(position > 0) {
+        const auto parent = (position - 1) / 2;
+        if(searchNodes[openList[parent]].f() <= f) {
+            break;
+        }
+        openList[position] = openList[parent];
+        searchNodes[openList[position]].openPosition = position;
+        position = parent;
+    }
+    openList[position] = face;
+    searchNodes[face].openPosition = position;
+}
+
+void RoutingEngine::openSiftDown(size_t position)
+{
+    const auto face = openList[position];
+    const auto f = searchNodes[face].f();
+    while(true) {
+        auto child = 2 * position + 1;
+        if(child >= openList.size()) {
+            break;
+        }
+        if(child + 1 < openList.size() &&
+           searchNodes[openList[child + 1]].f() < searchNodes[openList[child]].f()) {
+            ++child;
+        }
+        if(f <= searchNodes[openList[child]].f()) {
+            break;
+        }
+        openList[position] = openList[child];
+        searchNodes[openList[position]].openPosition = position;
+        position = child;
+    }
+    openList[position] = face;
+    searchNodes[face].openPosition = position;
+}
+
 bool RoutingEngine::IsRoutable(Point p) const
 {
     try {
@@ -271,11 +368,175 @@ bool RoutingEngine::IsRoutable(Point p) const
 
 void RoutingEngine::Update()
 {
+    destinationTrees.clear();
 }
 
-CDT::Face_handle RoutingEngine::find_face(K::Point_2 p) const
+void RoutingEngine::indexFaces()
 {
-    const auto face = cdt.locate(p);
+    faces.clear();
+    for(const CDT::Face_handle face : cdt.finite_face_handles()) {
+        if(face->get_in_domain()) {
+            face->set_index(faces.size());
+            faces.push_back(face);
+        }
+    }
+    searchNodes.assign(faces.size(), {});
+    searchGeneration = 0;
+    buildFaceGrid();
+}
+
+void RoutingEngine::buildFaceGrid()
+{
+    faceGrid.clear();
+    faceGridColumns = 0;
+    faceGridRows = 0;
+    if(faces.empty()) {
+        return;
+    }
+
+    const auto pointOf = [](const auto& vertex) {
+        return Point{CGAL::to_double(vertex->point().x()), CGAL::to_double(vertex->point().y())};
+    };
+    Point min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    Point max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for(const auto& face : faces) {
+        for(int idx = 0; idx < 3; ++idx) {
+            const auto p = pointOf(face->vertex(idx));
+            min = {std::min(min.x, p.x), std::min(min.y, p.y)};
+            max = {std::max(max.x, p.x), std::max(max.y, p.y)};
+        }
+    }
+
+    // Roughly one cell per face, faces are found within a few steps from the face of the cell
+    const auto extent = max - min;
+    faceGridOrigin = min;
+    faceGridCellSize = std::sqrt(extent.x * extent.y / static_cast<double>(faces.size()));
+    if(!(faceGridCellSize > 0.0)) {
+        faceGridCellSize = std::max({extent.x, extent.y, 1.0});
+    }
+    faceGridColumns = static_cast<size_t>(extent.x / faceGridCellSize) + 1;
+    faceGridRows = static_cast<size_t>(extent.y / faceGridCellSize) + 1;
+    faceGrid.assign(faceGridColumns * faceGridRows, InvalidIndex);
+
+    const auto cellOf = [this](Point p) {
+        const auto column = std::min(
+            static_cast<size_t>((p.x - faceGridOrigin.x) / faceGridCellSize), faceGridColumns - 1);
+        const auto row = std::min(
+            static_cast<size_t>((p.y - faceGridOrigin.y) / faceGridCellSize), faceGridRows - 1);
+        return std::make_pair(column, row);
+    };
+    // Cells containing the centroid of a face are assigned first, remaining cells get any face
+    // whose bounding box overlaps them.
+    for(const auto& face : faces) {
+        const auto centroid =
+            (pointOf(face->vertex(0)) + pointOf(face->vertex(1)) + pointOf(face->vertex(2))) /
+            3.0;
+        const auto [column, row] = cellOf(centroid);
+        faceGrid[row * faceGridColumns + column] = face->get_index();
+    }
+    for(const auto& face : faces) {
+        const auto a = pointOf(face->vertex(0));
+        const auto b = pointOf(face->vertex(1));
+        const auto c = pointOf(face->vertex(2));
+        const auto [minColumn, minRow] =
+            cellOf({std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y})});
+        const auto [maxColumn, maxRow] =
+            cellOf({std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y})});
+        for(auto row = minRow; row <= maxRow; ++row) {
+            for(auto column = minColumn; column <= maxColumn; ++column) {
+                auto& cell = faceGrid[row * faceGridColumns + column];
+                if(cell == InvalidIndex) {
+                    cell = face->get_index();
+                }
+            }
+        }
+    }
+}
+
+const RoutingEngine::DestinationTree&
+RoutingEngine::destinationTree(Point destination, size_t face)
+{
+    const auto key = std::make_pair(destination.x, destination.y);
+    auto iter = destinationTrees.find(key);
+    if(iter == std::end(destinationTrees)) {
+        const auto to = find_face({destination.x, destination.y});
+        if(destinationTrees.size() >= MAX_CACHED_DESTINATION_TREES) {
+            destinationTrees.erase(std::min_element(
+                std::begin(destinationTrees), std::end(destinationTrees), [](auto& a, auto& b) {
+                    return a.second.lastUse < b.second.lastUse;
+                }));
+        }
+        iter = destinationTrees.try_emplace(key).first;
+        auto& tree = iter->second;
+        tree.destinationFace = to->get_index();
+        tree.next.assign(faces.size(), InvalidIndex);
+        tree.settled.assign(faces.size(), false);
+        tree.distance.assign(faces.size(), std::numeric_limits<double>::infinity());
+        tree.anchors.resize(faces.size());
+        tree.distance[tree.destinationFace] = 0;
+        tree.anchors[tree.destinationFace] = destination;
+        tree.open.emplace(0, tree.destinationFace);
+    }
+    auto& tree = iter->second;
+    tree.lastUse = ++destinationTreeUses;
+    growDestinationTree(tree, face);
+    return tree;
+}
+
+void RoutingEngine::growDestinationTree(DestinationTree& tree, size_t face) const
+{
+    if(tree.settled.empty()) {
+        return;
+    }
+    // Dijkstra from the destination. Faces are settled in order of their distance, so the search
+    // stops once 'face' is settled and later queries for faces farther away resume it.
+    while(!tree.open.empty() && !tree.settled[face]) {
+        const auto [distance, current] = tree.open.top();
+        tree.open.pop();
+        if(tree.settled[current]) {
+            continue;
+        }
+        tree.settled[current] = true;
+        const auto currentFace = faces[current];
+        for(int idx = 0; idx < 3; ++idx) {
+            const auto neighbor = currentFace->neighbor(idx);
+            if(!neighbor->get_in_domain()) {
+                continue;
+            }
+            const auto edge = cdt.segment(currentFace, idx);
+            const Point midpoint{
+                (CGAL::to_double(edge.source().x()) + CGAL::to_double(edge.target().x())) / 2,
+                (CGAL::to_double(edge.source().y()) + CGAL::to_double(edge.target().y())) / 2};
+            const auto candidate = distance + Distance(tree.anchors[current], midpoint);
+            const auto successor = neighbor->get_index();
+            if(candidate < tree.distance[successor]) {
+                tree.distance[successor] = candidate;
+                tree.next[successor] = current;
+                tree.anchors[successor] = midpoint;
+                tree.open.emplace(candidate, successor);
+            }
+        }
+    }
+    if(tree.open.empty()) {
+        tree.settled = {};
+        tree.distance = {};
+        tree.anchors = {};
+        tree.open = {};
+    }
+}
+
+CDT::Face_handle RoutingEngine::find_face(K::Point_2 p, size_t faceHint) const
+{
+    if(faceHint == NoFaceHint && !faceGrid.empty()) {
+        const auto x = (CGAL::to_double(p.x()) - faceGridOrigin.x) / faceGridCellSize;
+        const auto y = (CGAL::to_double(p.y()) - faceGridOrigin.y) / faceGridCellSize;
+        if(x >= 0.0 && y >= 0.0 && x < static_cast<double>(faceGridColumns) &&
+           y < static_cast<double>(faceGridRows)) {
+            faceHint = faceGrid[static_cast<size_t>(y) * faceGridColumns + static_cast<size_t>(x)];
+        }
+    }
+    const auto face =
+        cdt.locate(p, faceHint == NoFaceHint ? CDT::Face_handle{} : faces[faceHint]);
     if(face == nullptr || cdt.is_infinite(face) || !face->get_in_domain()) {
         throw SimulationError(
             "Point ({}, {}) is outside of accessible area",
@@ -287,10 +548,22 @@ CDT::Face_handle RoutingEngine::find_face(K::Point_2 p) const
 
 std::vector<Point>
 RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_handle>& path)
+{
+    return funnel(from, to, [&path](size_t index) {
+        return index < path.size() ? path[index] : CDT::Face_handle{};
+    });
+}
+
+template <typename FaceAt>
+std::vector<Point> RoutingEngine::funnel(
+    Point from,
+    Point to,
+    FaceAt&& faceAt,
+    size_t maxWaypoints,
+    std::vector<size_t>* passedAt) const
 {
     // TODO(kkratz): Remove the 0.2m edge width adjustment and replace this with p[roper
     // arc-paths from the "Efficient Triangulation-Based Pathfinding" publication
-    const size_t portalCount = path.size();
 
     // This is the actual simple stupid funnel algorithm
     auto apex = from;
@@ -316,13 +589,11 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
     };
 
     std::vector<Point> waypoints{from};
-    // This is an overestimation but IMO preferable to repeated allocations.
-    // Ideally we replace this with something w.o. allocations
-    waypoints.reserve(path.size() + 1);
-    for(size_t index_portal = 1; index_portal <= portalCount; ++index_portal) {
-        const auto face_from = path[index_portal - 1];
-        const auto portal = index_portal < portalCount ? get_edge(face_from, path[index_portal]) :
-                                                         LineSegment(to, to);
+    for(size_t index_portal = 1;; ++index_portal) {
+        const auto face_from = faceAt(index_portal - 1);
+        const auto face_to = faceAt(index_portal);
+        const auto isLastPortal = face_to == CDT::Face_handle{};
+        const auto portal = isLastPortal ? LineSegment(to, to) : get_edge(face_from, face_to);
 
         const auto line_segment_left = portal.p2;
         const auto line_segment_right = portal.p1;
@@ -336,6 +607,12 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
                 index_right = index_portal;
             } else {
                 waypoints.emplace_back(portal_left);
+                if(passedAt != nullptr) {
+                    passedAt->push_back(index_left);
+                }
+                if(waypoints.size() == maxWaypoints) {
+                    return waypoints;
+                }
                 apex = portal_left;
                 index_apex = index_left;
                 portal_left = apex;
@@ -352,6 +629,12 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
                 index_left = index_portal;
             } else {
                 waypoints.emplace_back(portal_right);
+                if(passedAt != nullptr) {
+                    passedAt->push_back(index_right);
+                }
+                if(waypoints.size() == maxWaypoints) {
+                    return waypoints;
+                }
                 apex = portal_right;
                 index_apex = index_right;
                 portal_left = apex;
@@ -362,6 +645,9 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
                 continue;
             }
         }
+        if(isLastPortal) {
+            break;
+        }
     }
     waypoints.emplace_back(to);
     return waypoints;
@@ -4,23 +4,117 @@
 #include "CfgCgal.hpp"
 #include "Mesh.hpp"
 #include "Point.hpp"
+#include "Polyanya.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <queue>
+#include <utility>
 #include <variant>
 #include <vector>
 
 using LocationID = size_t;
 using Location = std::variant<Point, LocationID>;
 
+/// Search used by 'RoutingEngine::ComputeAllWaypoints'.
+enum class RoutingAlgorithm {
+    /// A* over the triangles followed by the funnel algorithm.
+    TriangleAStar,
+    /// Any-angle search over the triangles merged into convex polygons, see 'Polyanya'.
+    Polyanya
+};
+
 class RoutingEngine
 {
+    /// Next face towards one destination for every face in the domain. The tree is grown by a
+    /// Dijkstra search from the destination only as far as the queried faces need it.
+    struct DestinationTree {
+        size_t destinationFace{};
+        /// Index of the next face towards the destination, invalid for the destination face and
+        /// faces that cannot reach the destination. Final once a face is settled.
+        std::vector<size_t> next{};
+        /// State of the search, released once all faces are settled. Faces are reached at the
+        /// midpoint ('anchors') of the edge they share with the next face, 'distance' is the
+        /// length of the path through these midpoints.
+        std::vector<bool> settled{};
+        std::vector<double> distance{};
+        std::vector<Point> anchors{};
+        using Entry = std::pair<double, size_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open{};
+        /// Value of 'destinationTreeUses' when the tree was last used.
+        uint64_t lastUse{};
+    };
+
+    /// Trees of rarely used destinations are evicted once more destinations are in use.
+    static constexpr size_t MAX_CACHED_DESTINATION_TREES{64};
+    static constexpr size_t InvalidIndex{std::numeric_limits<size_t>::max()};
+
     CDT cdt{};
     std::unique_ptr<Mesh> mesh{};
+    /// All faces in the domain, the position of a face is stored in the face.
+    std::vector<CDT::Face_handle> faces{};
+    std::map<std::pair<double, double>, DestinationTree> destinationTrees{};
+    uint64_t destinationTreeUses{};
+    /// Faces towards the destination of the current 'ComputeWaypoint' query, reused between calls.
+    std::vector<CDT::Face_handle> corridor{};
+
+    /// A* state of a face in 'ComputeAllWaypoints', only valid if 'generation' matches
+    /// 'searchGeneration'. Closed faces are not in the open list.
+    struct SearchNode {
+        uint64_t generation{};
+        double g{};
+        double h{};
+        size_t parent{InvalidIndex};
+        /// Position in 'openList', invalid if the face is not in the open list.
+        size_t openPosition{InvalidIndex};
+
+        double f() const { return g + h; }
+    };
+    /// Search state of every face, reused between queries.
+    std::vector<SearchNode> searchNodes{};
+    uint64_t searchGeneration{};
+    /// Binary min-heap of face indices ordered by f-value.
+    std::vector<size_t> openList{};
+    std::vector<CDT::Face_handle> searchPath{};
+    size_t lastSearchExpansions{};
+
+    /// Uniform grid over the domain, every cell holds the index of a face close to it. Point
+    /// location starts in this face when no hint is given.
+    Point faceGridOrigin{};
+    double faceGridCellSize{1.0};
+    size_t faceGridColumns{};
+    size_t faceGridRows{};
+    std::vector<size_t> faceGrid{};
+
+    RoutingAlgorithm algorithm{RoutingAlgorithm::TriangleAStar};
+    /// Built from a merged copy of 'mesh' on first use of 'RoutingAlgorithm::Polyanya'.
+    std::unique_ptr<Polyanya> polyanya{};
 
 public:
+    /// Face hint for point location meaning no face is known.
+    static constexpr size_t NoFaceHint{InvalidIndex};
+
+    /// Path to a destination together with the faces of the triangulation it runs through.
+    struct Route {
+        /// Indices of the faces from the face containing the start to the face containing the
+        /// destination.
+        std::vector<size_t> corridor{};
+        /// Corners of the path, the last waypoint is the destination.
+        std::vector<Point> waypoints{};
+        /// For every waypoint the position in 'corridor' of the first face behind it. Agents in
+        /// this face or any later face have passed the waypoint. The destination is never passed.
+        std::vector<size_t> passedAt{};
+    };
+
     RoutingEngine();
     explicit RoutingEngine(const PolyWithHoles& poly);
+    /// Creates a routing engine from a previously built triangulation and mesh, e.g. read from a
+    /// 'GeometryCache'. Faces of 'triangulation' need to be marked as in or out of the domain.
+    RoutingEngine(CDT&& triangulation, std::unique_ptr<Mesh> mesh);
     ~RoutingEngine() = default;
 
     RoutingEngine(const RoutingEngine& other) = delete;
@@ -29,15 +123,60 @@ public:
     RoutingEngine(RoutingEngine&& other) = default;
     RoutingEngine& operator=(RoutingEngine&& other) = default;
 
+    /// Computes the next waypoint on the way to 'destination'. The path to every destination is
+    /// taken from a shortest path tree over the triangulation that is cached and grown as far as
+    /// the queried positions need it, only the funnel up to the next corner is computed per call.
+    /// @throws SimulationError if 'destination' cannot be reached from 'currentPosition'
     Point ComputeWaypoint(Point currentPosition, Point destination);
+    /// Computes the whole path to 'destination' with the search selected by 'SetAlgorithm'.
+    /// @throws SimulationError if 'destination' cannot be reached from 'currentPosition'
     std::vector<Point> ComputeAllWaypoints(Point currentPosition, Point destination);
+    /// Computes the whole path to 'destination' along the cached shortest path tree.
+    /// 'faceHint' is the index of a face close to 'currentPosition', e.g. the face the agent was
+    /// found in last. The face containing 'currentPosition' is the first face of the corridor.
+    /// @throws SimulationError if 'destination' cannot be reached from 'currentPosition'
+    Route ComputeRoute(Point currentPosition, Point destination, size_t faceHint = NoFaceHint);
+    /// Checks if 'p' is inside or on the boundary of the face with index 'face' of a 'Route'.
+    bool FaceContains(size_t face, Point p) const;
     bool IsRoutable(Point p) const;
+    /// Drops all cached shortest path trees.
     void Update();
+    /// Number of destinations with a cached shortest path tree.
+    size_t CachedDestinationCount() const { return destinationTrees.size(); }
+    /// Number of faces or Polyanya nodes expanded by the last 'ComputeAllWaypoints' query.
+    size_t LastSearchExpansions() const { return lastSearchExpansions; }
+    /// Selects the search used by 'ComputeAllWaypoints'. 'ComputeWaypoint' and 'ComputeRoute'
+    /// always use the cached shortest path trees.
+    void SetAlgorithm(RoutingAlgorithm algorithm_) { algorithm = algorithm_; }
+    RoutingAlgorithm Algorithm() const { return algorithm; }
 
     const Mesh* MeshData() const { return mesh.get(); };
+    const CDT& Triangulation() const { return cdt; };
 
 private:
-    CDT::Face_handle find_face(K::Point_2) const;
+    void indexFaces();
+    void buildFaceGrid();
+    /// Locates the domain face containing 'p', starting the search in 'faceHint' or in the face
+    /// stored in the grid cell of 'p'.
+    CDT::Face_handle find_face(K::Point_2 p, size_t faceHint = NoFaceHint) const;
+    std::vector<Point> computeAllWaypointsPolyanya(Point currentPosition, Point destination);
+    /// Tree of 'destination' grown until 'face' is settled or found to be unreachable.
+    const DestinationTree& destinationTree(Point destination, size_t face);
+    void growDestinationTree(DestinationTree& tree, size_t face) const;
+    void openPush(size_t face);
+    size_t openPop();
+    void openSiftUp(size_t position);
+    void openSiftDown(size_t position);
     std::vector<Point>
     straightenPath(Point from, Point to, const std::vector<CDT::Face_handle>& path);
+    /// Funnel algorithm over the faces returned by 'faceAt(0)', 'faceAt(1)', ... until 'faceAt'
+    /// returns a null handle. Stops once 'maxWaypoints' waypoints including 'from' are found.
+    /// If 'passedAt' is given, the position of the first face behind every corner is appended.
+    template <typename FaceAt>
+    std::vector<Point> funnel(
+        Point from,
+        Point to,
+        FaceAt&& faceAt,
+        size_t maxWaypoints = std::numeric_limits<size_t>::max(),
+        std::vector<size_t>* passedAt = nullptr) const;
 };
@@ -3,6 +3,7 @@
 
 #include "CollisionGeometry.hpp"
 #include "GenericAgent.hpp"
+#include "GeometryCache.hpp"
 #include "IteratorPair.hpp"
 #include "Journey.hpp"
 #include "OperationalModel.hpp"
@@ -20,6 +21,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -55,14 +57,33 @@ void Simulation::ThrowIfIterating(const char* operation) const
     }
 }
 
+const GenericAgent* Simulation::FindAgent(GenericAgent::ID id) const
+{
+    const auto iter = _agentIndices.find(id);
+    if(iter == std::end(_agentIndices)) {
+        return nullptr;
+    }
+    return &_agents[iter->second];
+}
+
+GenericAgent* Simulation::FindAgent(GenericAgent::ID id)
+{
+    return const_cast<GenericAgent*>(std::as_const(*this).FindAgent(id));
+}
+
 Simulation::Simulation(
     std::unique_ptr<OperationalModel>&& operationalModel,
-    std::unique_ptr<CollisionGeometry>&& geometry,
-    double dT)
+    std::shared_ptr<const CollisionGeometry> geometry,
+    double dT,
+    const std::filesystem::path& geometryCacheDirectory)
     : _clock(dT)
     , _operationalDecisionSystem(std::move(operationalModel))
     , _geometry(std::move(geometry))
-    , _routingEngine(std::make_unique<RoutingEngine>(_geometry->Polygon()))
+    , _neighborhoodSearch(2.2, _geometry->Bounds())
+    , _routingEngine(
+          geometryCacheDirectory.empty() ?
+              std::make_unique<RoutingEngine>(_geometry->Polygon()) :
+              GeometryCache(geometryCacheDirectory).LoadOrBuild(_geometry->Polygon()))
 {
 }
 
@@ -80,20 +101,105 @@ void Simulation::SetTracing(bool status)
     }
 };
 
+void Simulation::SetThreadCount(size_t threadCount)
+{
+    ThrowIfIterating("SetThreadCount");
+    if(threadCount == 0) {
+        throw SimulationError("Thread count needs to be at least 1");
+    }
+    _operationalDecisionSystem.SetThreadCount(threadCount);
+}
+
+size_t Simulation::ThreadCount() const
+{
+    return _operationalDecisionSystem.ThreadCount();
+}
+
+void Simulation::SetNeighborListSkin(double skin)
+{
+    ThrowIfIterating("SetNeighborListSkin");
+    if(skin < 0) {
+        throw SimulationError("Neighbor list skin needs to be positive or 0, got {}", skin);
+    }
+    if(skin == 0) {
+        _neighborhoodSearch.DisableNeighborLists();
+    } else {
+        const auto cutOffRadius = _operationalDecisionSystem.CutOffRadius();
+        if(cutOffRadius <= 0) {
+            throw SimulationError(
+                "{} does not support neighbor lists",
+                ToString(_operationalDecisionSystem.ModelType()));
+        }
+        _neighborhoodSearch.EnableNeighborLists(cutOffRadius, skin);
+    }
+    _neighborListSkin = skin;
+}
+
+double Simulation::NeighborListSkin() const
+{
+    return _neighborListSkin;
+}
+
+void Simulation::SetWallDistanceFieldResolution(double resolution)
+{
+    ThrowIfIterating("SetWallDistanceFieldResolution");
+    auto geometry = std::make_shared<CollisionGeometry>(*_geometry);
+    geometry->BuildWallDistanceField(resolution);
+    _geometry = std::move(geometry);
+}
+
+double Simulation::WallDistanceFieldResolution() const
+{
+    const auto* wallDistances = _geometry->WallDistances();
+    return wallDistances != nullptr ? wallDistances->Resolution() : 0.;
+}
+
+size_t Simulation::NeighborListRebuildCount() const
+{
+    return _neighborListRebuilds;
+}
+
+size_t Simulation::RouteReplanCount() const
+{
+    return _routeReplansInLastIteration;
+}
+
 void Simulation::Iterate()
 {
     ThrowIfIterating("Iterate");
     IterationScope iterationScope(_iterating);
     JPS_SCOPED_TIMER_AND_TRACE(_timer, "Total Iteration", General);
 
+    const bool agentsRemoved = !_removedAgentsInLastIteration.empty();
     {
         JPS_SCOPED_TIMER_AND_TRACE(_timer, "Agent Removal System", Detailed);
-        _agentRemovalSystem.Run(_agents, _removedAgentsInLastIteration, _stageManager);
+        for(const auto id : _removedAgentsInLastIteration) {
+            _agentIndices.erase(id);
+            _tacticalDecisionSystem.RemoveAgent(id);
+        }
+        const auto firstRemoved =
+            _agentRemovalSystem.Run(_agents, _removedAgentsInLastIteration, _stageManager);
+        for(size_t index = firstRemoved; index < _agents.size(); ++index) {
+            _agentIndices[_agents[index].id] = index;
+        }
     }
 
     {
         JPS_SCOPED_TIMER_AND_TRACE(_timer, "Neighborhood Search", Detailed);
-        _neighborhoodSearch.Update(_agents);
+        // The grid is kept up to date at the end of each iteration. Removing agents shifts the
+        // container and requires a rebuild, otherwise only agents moved in between, e.g. by
+        // user code, are relocated.
+        if(agentsRemoved) {
+            _neighborhoodSearch.Update(_agents);
+        } else {
+            _neighborhoodSearch.UpdatePositions(_agents);
+        }
+    }
+
+    if(_neighborhoodSearch.NeighborListsOutdated()) {
+        JPS_SCOPED_TIMER_AND_TRACE(_timer, "Neighbor List Rebuild", General);
+        _neighborhoodSearch.RebuildNeighborLists();
+        ++_neighborListRebuilds;
     }
 
     {
@@ -108,17 +214,17 @@ void Simulation::Iterate()
 
     {
         JPS_SCOPED_TIMER_AND_TRACE(_timer, "Tactical Decision System", General);
-        _tacticalDecisionSystem.Run(*_routingEngine, _agents);
+        _routeReplansInLastIteration = _tacticalDecisionSystem.Run(*_routingEngine, _agents);
     }
 
     {
         JPS_SCOPED_TIMER_AND_TRACE(_timer, "Operational Decision System", General);
         _operationalDecisionSystem.Run(
             _clock.dT(), _clock.ElapsedTime(), _neighborhoodSearch, *_geometry, _agents);
-        // Agents moved during the operational step; rebuild the grid so cell membership
-        // reflects the new positions for queries before the next iteration (AgentsInRange,
-        // AddAgent validation).
-        _neighborhoodSearch.Update(_agents);
+        // Agents moved during the operational step; relocate them in the grid so cell
+        // membership reflects the new positions for queries before the next iteration
+        // (AgentsInRange, AddAgent validation) and for the next stage system run.
+        _neighborhoodSearch.UpdatePositions(_agents);
     }
     _clock.Advance();
 }
@@ -268,6 +374,7 @@ GenericAgent::ID Simulation::AddAgent(GenericAgent agent)
 
     _stageManager.HandleNewAgent(agent.stageId);
     _agents.emplace_back(std::move(agent));
+    _agentIndices.emplace(_agents.back().id, _agents.size() - 1);
     _neighborhoodSearch.AddAgent(_agents.back());
 
     auto v = IteratorPair(std::prev(std::end(_agents)), std::end(_agents));
@@ -280,9 +387,7 @@ void Simulation::MarkAgentForRemoval(GenericAgent::ID id)
 {
     ThrowIfIterating("MarkAgentForRemoval");
     JPS_TRACE_FUNC;
-    const auto iter = std::find_if(
-        std::begin(_agents), std::end(_agents), [id](auto& agent) { return agent.id == id; });
-    if(iter == std::end(_agents)) {
+    if(FindAgent(id) == nullptr) {
         throw SimulationError("Unknown agent id {}", id);
     }
 
@@ -292,23 +397,21 @@ void Simulation::MarkAgentForRemoval(GenericAgent::ID id)
 const GenericAgent& Simulation::Agent(GenericAgent::ID id) const
 {
     JPS_TRACE_FUNC;
-    const auto iter =
-        std::find_if(_agents.begin(), _agents.end(), [id](auto& ped) { return id == ped.id; });
-    if(iter == _agents.end()) {
+    const auto agent = FindAgent(id);
+    if(agent == nullptr) {
         throw SimulationError("Trying to access unknown Agent {}", id);
     }
-    return *iter;
+    return *agent;
 }
 
 GenericAgent& Simulation::Agent(GenericAgent::ID id)
 {
     JPS_TRACE_FUNC;
-    const auto iter =
-        std::find_if(_agents.begin(), _agents.end(), [id](auto& ped) { return id == ped.id; });
-    if(iter == _agents.end()) {
+    const auto agent = FindAgent(id);
+    if(agent == nullptr) {
         throw SimulationError("Trying to access unknown Agent {}", id);
     }
-    return *iter;
+    return *agent;
 }
 
 const std::vector<GenericAgent::ID>& Simulation::RemovedAgents() const
@@ -365,15 +468,9 @@ void Simulation::SwitchAgentJourney(
 std::vector<GenericAgent::ID> Simulation::AgentsInRange(Point p, double distance)
 {
     JPS_SCOPED_TIMER_AND_TRACE(_timer, "Agents in Range", Debug);
-    const auto neighbors = _neighborhoodSearch.GetNeighboringAgents(p, distance);
-
     std::vector<GenericAgent::ID> neighborIds{};
-    neighborIds.reserve(neighbors.size());
-    std::transform(
-        std::begin(neighbors),
-        std::end(neighbors),
-        std::back_inserter(neighborIds),
-        [](const auto& agent) { return agent.id; });
+    _neighborhoodSearch.ForEachNeighbor(
+        p, distance, [&neighborIds](const auto& agent) { neighborIds.push_back(agent.id); });
     return neighborIds;
 }
 
@@ -386,15 +483,12 @@ std::vector<GenericAgent::ID> Simulation::AgentsInPolygon(const std::vector<Poin
     }
     const auto [p, dist] = poly.ContainingCircle();
 
-    const auto candidates = _neighborhoodSearch.GetNeighboringAgents(p, dist);
     std::vector<GenericAgent::ID> result{};
-    result.reserve(candidates.size());
-    std::for_each(
-        std::begin(candidates), std::end(candidates), [&result, &poly](const auto& agent) {
-            if(poly.IsInside(agent.position())) {
-                result.push_back(agent.id);
-            }
-        });
+    _neighborhoodSearch.ForEachNeighbor(p, dist, [&result, &poly](const auto& agent) {
+        if(poly.IsInside(agent.position())) {
+            result.push_back(agent.id);
+        }
+    });
     return result;
 }
 
@@ -407,9 +501,9 @@ StageProxy Simulation::Stage(BaseStage::ID stageId)
 {
     return _stageManager.Stage(stageId)->Proxy(this);
 }
-CollisionGeometry Simulation::Geo() const
+std::shared_ptr<const CollisionGeometry> Simulation::Geo() const
 {
-    return *_geometry;
+    return _geometry;
 }
 
 void Simulation::PushTimer(const std::string_view name, size_t probe_log_level)
@@ -431,3 +525,8 @@ std::map<std::string, TimerEntry::duration_type> Simulation::GetTimerDurations()
 {
     return _timer.getDurations();
 }
+
+uint64_t Simulation::GetTimerCount(const std::string_view name) const
+{
+    return _timer.getCount(name);
+}
@@ -23,6 +23,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <tuple>
@@ -38,11 +39,18 @@ class Simulation
     AgentRemovalSystem<GenericAgent> _agentRemovalSystem{};
     StageManager _stageManager{};
     StageSystem _stageSystem{};
-    NeighborhoodSearch<GenericAgent> _neighborhoodSearch{2.2};
-    std::unique_ptr<CollisionGeometry> _geometry{};
+    /// Shared with callers of 'Geo()' and never modified, changes replace the geometry.
+    std::shared_ptr<const CollisionGeometry> _geometry{};
+    NeighborhoodSearch<GenericAgent> _neighborhoodSearch;
+    double _neighborListSkin{0};
     std::unique_ptr<RoutingEngine> _routingEngine{};
     AgentContainer<GenericAgent> _agents;
+    /// Position of each agent in '_agents'. The operational step keeps the agent order, only
+    /// adding and removing agents changes it.
+    std::unordered_map<GenericAgent::ID, size_t> _agentIndices{};
     std::vector<GenericAgent::ID> _removedAgentsInLastIteration;
+    size_t _routeReplansInLastIteration{0};
+    size_t _neighborListRebuilds{0};
     std::unordered_map<Journey::ID, std::unique_ptr<Journey>> _journeys;
     Timer _timer{};
     /// Set for the duration of Iterate(); mutating entry points must not run while the
@@ -51,12 +59,18 @@ class Simulation
     enum LogLevel { General = 1, Detailed = 2, Debug = 3 };
 
     void ThrowIfIterating(const char* operation) const;
+    /// Returns nullptr for unknown ids.
+    const GenericAgent* FindAgent(GenericAgent::ID id) const;
+    GenericAgent* FindAgent(GenericAgent::ID id);
 
 public:
+    /// @param geometryCacheDirectory directory of a 'GeometryCache' the routing data is loaded
+    /// from and stored to, empty to always build the routing data
     Simulation(
         std::unique_ptr<OperationalModel>&& operationalModel,
-        std::unique_ptr<CollisionGeometry>&& geometry,
-        double dT);
+        std::shared_ptr<const CollisionGeometry> geometry,
+        double dT,
+        const std::filesystem::path& geometryCacheDirectory = {});
     Simulation(const Simulation& other) = delete;
     Simulation& operator=(const Simulation& other) = delete;
     Simulation(Simulation&& other) = delete;
@@ -64,6 +78,28 @@ public:
     ~Simulation() = default;
     const SimulationClock& Clock() const;
     void SetTracing(bool on);
+    /// Sets the number of threads used to compute the operational step. Results are identical
+    /// for every thread count.
+    /// @param threadCount number of threads, needs to be at least 1
+    void SetThreadCount(size_t threadCount);
+    size_t ThreadCount() const;
+    /// Enables Verlet neighbor lists for the neighbor queries of the operational model. Lists
+    /// cover the cut off radius of the model plus 'skin' and are rebuilt once an agent moved
+    /// more than half the skin, see 'NeighborListRebuildCount'.
+    /// @param skin in meters, 0 disables the lists
+    void SetNeighborListSkin(double skin);
+    double NeighborListSkin() const;
+    /// Number of times the neighbor lists were rebuilt since the simulation was created.
+    size_t NeighborListRebuildCount() const;
+    /// Samples the distance to the walls on a grid, the collision free speed models then take
+    /// their boundary repulsion from the closest wall in the field.
+    /// Geometries returned by 'Geo()' before are not modified.
+    /// @param resolution distance between nodes in meters, 0 removes the field
+    void SetWallDistanceFieldResolution(double resolution);
+    double WallDistanceFieldResolution() const;
+    /// Number of agents whose path was recomputed by the tactical level in the last iteration,
+    /// all other agents kept following their previous path.
+    size_t RouteReplanCount() const;
     void Iterate();
     Journey::ID AddJourney(const std::map<BaseStage::ID, TransitionDescription>& stages);
     BaseStage::ID AddStage(const StageDescription stageDescription);
@@ -85,10 +121,13 @@ public:
     AgentContainer<GenericAgent>& Agents();
     OperationalModelType ModelType() const;
     StageProxy Stage(BaseStage::ID stageId);
-    CollisionGeometry Geo() const;
+    /// Geometry of the simulation, shared instead of copied. Check 'CollisionGeometry::Hash' to
+    /// detect a changed geometry.
+    std::shared_ptr<const CollisionGeometry> Geo() const;
     void PushTimer(const std::string_view name, size_t probe_log_level = 0);
     void PopTimer(const std::string_view name);
     void SetTimerLogLevel(int level) { _timer.setLogLevel(level); };
     TimerEntry::duration_type GetTimerDuration(const std::string_view name) const;
     std::map<std::string, TimerEntry::duration_type> GetTimerDurations() const;
+    uint64_t GetTimerCount(const std::string_view name) const;
 };
@@ -117,10 +117,10 @@ public:
     ID Id() const { return id; }
     size_t CountTargeting() const { return targeting; }
     void IncreaseTargeting() { targeting = targeting + 1; }
-    void DecreaseTargeting()
+    void DecreaseTargeting(size_t count = 1)
     {
-        assert(targeting >= 1);
-        targeting = targeting - 1;
+        assert(targeting >= count);
+        targeting = targeting - count;
     }
 };
 
@@ -201,29 +201,18 @@ void NotifiableWaitingSet::Update(
     for(size_t index = count_occupants; index < slots.size(); ++index) {
         const auto slot_pos = slots[index];
         const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(slot_pos);
-        auto candidates = neighborhoodSearch.GetNeighboringAgents(slot_pos, 2);
-        candidates.erase(
-            std::remove_if(
-                std::begin(candidates),
-                std::end(candidates),
-                [&slot_pos, &boundary](const auto& neighbor) {
-                    const auto agent_to_neighbor = LineSegment(slot_pos, neighbor.position());
-                    if(std::find_if(
-                           boundary.cbegin(),
-                           boundary.cend(),
-                           [&agent_to_neighbor](const auto& boundary_segment) {
-                               return intersects(agent_to_neighbor, boundary_segment);
-                           }) != boundary.end()) {
-                        return true;
-                    }
-
-                    return false;
-                }),
-            std::end(candidates));
-
         GenericAgent::ID occupant = GenericAgent::ID::Invalid;
         double min_distance = std::numeric_limits<double>::max();
-        for(const auto& agent : candidates) {
+        neighborhoodSearch.ForEachNeighbor(slot_pos, 2, [&](const auto& agent) {
+            const auto agent_to_neighbor = LineSegment(slot_pos, agent.position());
+            if(std::any_of(
+                   std::begin(boundary),
+                   std::end(boundary),
+                   [&agent_to_neighbor](const auto& segment) {
+                       return intersects(agent_to_neighbor, segment);
+                   })) {
+                return;
+            }
             if(agent.stageId == id) {
                 if(std::find(std::begin(occupants), std::end(occupants), agent.id) ==
                    std::end(occupants)) {
@@ -234,7 +223,7 @@ void NotifiableWaitingSet::Update(
                     }
                 }
             }
-        }
+        });
         if(occupant != GenericAgent::ID::Invalid) {
             occupants.push_back(occupant);
         } else {
@@ -277,39 +266,28 @@ void NotifiableQueue::Update(
     for(size_t index = count_occupants; index < slots.size(); ++index) {
         const auto slot_pos = slots[index];
         const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(slot_pos);
-        auto candidates = neighborhoodSearch.GetNeighboringAgents(slot_pos, 2);
-        candidates.erase(
-            std::remove_if(
-                std::begin(candidates),
-                std::end(candidates),
-                [&slot_pos, &boundary](const auto& neighbor) {
-                    const auto agent_to_neighbor = LineSegment(slot_pos, neighbor.position());
-                    if(std::find_if(
-                           boundary.cbegin(),
-                           boundary.cend(),
-                           [&agent_to_neighbor](const auto& boundary_segment) {
-                               return intersects(agent_to_neighbor, boundary_segment);
-                           }) != boundary.end()) {
-                        return true;
-                    }
-
-                    return false;
-                }),
-            std::end(candidates));
-
         GenericAgent::ID occupant = GenericAgent::ID::Invalid;
         double min_distance = std::numeric_limits<double>::max();
-        for(const auto& agent : candidates) {
+        neighborhoodSearch.ForEachNeighbor(slot_pos, 2, [&](const auto& agent) {
+            const auto agent_to_neighbor = LineSegment(slot_pos, agent.position());
+            if(std::any_of(
+                   std::begin(boundary),
+                   std::end(boundary),
+                   [&agent_to_neighbor](const auto& segment) {
+                       return intersects(agent_to_neighbor, segment);
+                   })) {
+                return;
+            }
             if(agent.stageId != id || Contains(occupants, agent.id) ||
                exitingThisUpdate.contains(agent.id)) {
-                continue;
+                return;
             }
             const auto distance = (agent.position() - slots[index]).Norm();
             if(distance < min_distance) {
                 min_distance = distance;
                 occupant = agent.id;
             }
-        }
+        });
         if(occupant != GenericAgent::ID::Invalid) {
             occupants.emplace_back(occupant);
         } else {
@@ -7,6 +7,7 @@
 #include "StageDescription.hpp"
 #include "Visitor.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -65,7 +66,10 @@ public:
     }
 
     void HandleNewAgent(BaseStage::ID stageId) { stages.at(stageId)->IncreaseTargeting(); }
-    void HandleRemoveAgent(BaseStage::ID stageId) { stages.at(stageId)->DecreaseTargeting(); }
+    void HandleRemoveAgent(BaseStage::ID stageId, size_t count = 1)
+    {
+        stages.at(stageId)->DecreaseTargeting(count);
+    }
 
     BaseStage* Stage(BaseStage::ID stageId) const
     {
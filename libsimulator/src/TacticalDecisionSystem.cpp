@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "TacticalDecisionSystem.hpp"
+
+#include "Point.hpp"
+#include "RoutingEngine.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+bool TacticalDecisionSystem::follow(
+    const RoutingEngine& routingEngine,
+    AgentPath& path,
+    Point position,
+    Point destination)
+{
+    const auto& corridor = path.route.corridor;
+    if(corridor.empty() || path.destination != destination) {
+        return false;
+    }
+
+    // Agents mostly stay in their face between iterations, check it before the faces around it
+    auto face = corridor.size();
+    if(routingEngine.FaceContains(corridor[path.face], position)) {
+        face = path.face;
+    } else {
+        const auto first = path.face > 0 ? path.face - 1 : 0;
+        const auto last = std::min(corridor.size(), path.face + CORRIDOR_LOOKAHEAD + 1);
+        for(auto candidate = first; candidate < last; ++candidate) {
+            if(routingEngine.FaceContains(corridor[candidate], position)) {
+                face = candidate;
+                break;
+            }
+        }
+    }
+    if(face == corridor.size()) {
+        return false;
+    }
+
+    path.face = face;
+    // The agent heads to the first waypoint it has not passed. Agents pushed back behind a corner
+    // head to that corner again. The destination is never passed, hence the second loop ends at
+    // the last waypoint.
+    const auto& passedAt = path.route.passedAt;
+    while(path.waypoint > 0 && passedAt[path.waypoint - 1] > face) {
+        --path.waypoint;
+    }
+    while(passedAt[path.waypoint] <= face) {
+        ++path.waypoint;
+    }
+    return true;
+}
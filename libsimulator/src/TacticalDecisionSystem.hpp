@@ -1,10 +1,31 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "GenericAgent.hpp"
+#include "Point.hpp"
 #include "RoutingEngine.hpp"
 
+#include <cstddef>
+#include <unordered_map>
+
 class TacticalDecisionSystem
 {
+    /// Path an agent follows, kept between iterations.
+    struct AgentPath {
+        Point destination{};
+        RoutingEngine::Route route{};
+        /// Position in 'route.corridor' of the face the agent was found in last.
+        size_t face{};
+        /// Index into 'route.waypoints' of the waypoint the agent heads to.
+        size_t waypoint{};
+    };
+
+    /// Number of faces ahead of the last known face searched for the agent before its path is
+    /// recomputed. Agents cross several small faces per iteration in fine triangulations.
+    static constexpr size_t CORRIDOR_LOOKAHEAD{8};
+
+    std::unordered_map<GenericAgent::ID, AgentPath> _paths{};
+
 public:
     TacticalDecisionSystem() = default;
     ~TacticalDecisionSystem() = default;
@@ -13,11 +34,38 @@ public:
     TacticalDecisionSystem(TacticalDecisionSystem&& other) = delete;
     TacticalDecisionSystem& operator=(TacticalDecisionSystem&& other) = delete;
 
-    void Run(RoutingEngine& routingEngine, auto&& agents) const
+    /// Sets the next waypoint of all agents. The path of an agent is only recomputed when its
+    /// destination changed or it left the corridor of faces the path runs through, otherwise
+    /// the agent advances along the waypoints of its path.
+    /// @return number of agents whose path was recomputed
+    size_t Run(RoutingEngine& routingEngine, auto&& agents)
     {
+        size_t replans{0};
         for(auto& agent : agents) {
-            const auto dest = agent.finalTarget;
-            agent.nextTarget = routingEngine.ComputeWaypoint(agent.position(), dest);
+            auto& path = _paths[agent.id];
+            if(!follow(routingEngine, path, agent.position(), agent.finalTarget)) {
+                // The face the agent was found in last is close to its position
+                const auto faceHint = path.route.corridor.empty() ?
+                                          RoutingEngine::NoFaceHint :
+                                          path.route.corridor[path.face];
+                path.destination = agent.finalTarget;
+                path.route =
+                    routingEngine.ComputeRoute(agent.position(), agent.finalTarget, faceHint);
+                path.face = 0;
+                path.waypoint = 0;
+                ++replans;
+            }
+            agent.nextTarget = path.route.waypoints[path.waypoint];
         }
+        return replans;
     }
+
+    /// Forgets the path of a removed agent.
+    void RemoveAgent(GenericAgent::ID id) { _paths.erase(id); }
+
+private:
+    /// Advances 'path' to the current position of the agent.
+    /// @return false if the path needs to be recomputed
+    static bool
+    follow(const RoutingEngine& routingEngine, AgentPath& path, Point position, Point destination);
 };
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    const auto workerCount = std::max<size_t>(threadCount, 1) - 1;
+    _workers.reserve(workerCount);
+    for(size_t chunk = 1; chunk <= workerCount; ++chunk) {
+        _workers.emplace_back([this, chunk]() { workerLoop(chunk); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _shutdown = true;
+    }
+    _workAvailable.notify_all();
+    for(auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const RangeFn& fn)
+{
+    if(count == 0) {
+        return;
+    }
+    if(_workers.empty() || count == 1) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        _fn = &fn;
+        _count = count;
+        _errors.assign(ThreadCount(), nullptr);
+        _pending = _workers.size();
+        ++_generation;
+    }
+    _workAvailable.notify_all();
+
+    runChunk(0);
+
+    {
+        std::unique_lock lock(_mutex);
+        _workDone.wait(lock, [this]() { return _pending == 0; });
+        _fn = nullptr;
+    }
+
+    for(const auto& error : _errors) {
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ThreadPool::workerLoop(size_t chunk)
+{
+    uint64_t seenGeneration = 0;
+    while(true) {
+        {
+            std::unique_lock lock(_mutex);
+            _workAvailable.wait(lock, [this, seenGeneration]() {
+                return _shutdown || _generation != seenGeneration;
+            });
+            if(_shutdown) {
+                return;
+            }
+            seenGeneration = _generation;
+        }
+
+        runChunk(chunk);
+
+        {
+            std::lock_guard lock(_mutex);
+            --_pending;
+            if(_pending == 0) {
+                _workDone.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runChunk(size_t chunk)
+{
+    const auto threadCount = ThreadCount();
+    const auto begin = _count * chunk / threadCount;
+    const auto end = _count * (chunk + 1) / threadCount;
+    if(begin == end) {
+        return;
+    }
+    try {
+        (*_fn)(begin, end);
+    } catch(...) {
+        _errors[chunk] = std::current_exception();
+    }
+}
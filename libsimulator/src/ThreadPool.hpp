@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed size pool of worker threads used to fan out data parallel loops.
+///
+/// The calling thread always takes part in the work, so a pool with a thread count of 1 spawns
+/// no workers and executes everything inline.
+class ThreadPool
+{
+public:
+    /// Work item, processes the half open index range [begin, end).
+    using RangeFn = std::function<void(size_t begin, size_t end)>;
+
+private:
+    std::vector<std::thread> _workers{};
+    std::mutex _mutex{};
+    std::condition_variable _workAvailable{};
+    std::condition_variable _workDone{};
+    const RangeFn* _fn{nullptr};
+    size_t _count{0};
+    uint64_t _generation{0};
+    size_t _pending{0};
+    bool _shutdown{false};
+    std::vector<std::exception_ptr> _errors{};
+
+public:
+    /// @param threadCount total number of threads working on a loop including the caller, 0 is
+    /// treated as 1.
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ThreadPool(ThreadPool&& other) = delete;
+    ThreadPool& operator=(ThreadPool&& other) = delete;
+
+    size_t ThreadCount() const { return _workers.size() + 1; }
+
+    /// Splits [0, count) into one contiguous chunk per thread and blocks until all chunks are
+    /// processed. If chunks throw, the exception of the chunk with the lowest indices is
+    /// rethrown, i.e. the same one a serial loop would have raised first.
+    void ParallelFor(size_t count, const RangeFn& fn);
+
+private:
+    void workerLoop(size_t chunk);
+    void runChunk(size_t chunk);
+};
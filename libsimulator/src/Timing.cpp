@@ -14,9 +14,11 @@ namespace cr = std::chrono;
 TimerEntry::TimerEntry(TimerEntry&& other) noexcept
     : started_at(std::move(other.started_at))
     , duration_in_microseconds(other.duration_in_microseconds)
+    , count(other.count)
     , running(other.running)
 {
     other.duration_in_microseconds = 0;
+    other.count = 0;
     other.running = false;
 }
 
@@ -25,8 +27,10 @@ TimerEntry& TimerEntry::operator=(TimerEntry&& other) noexcept
     if(this != &other) {
         started_at = std::move(other.started_at);
         duration_in_microseconds = other.duration_in_microseconds;
+        count = other.count;
         running = other.running;
         other.duration_in_microseconds = 0;
+        other.count = 0;
         other.running = false;
     }
     return *this;
@@ -36,6 +40,7 @@ void TimerEntry::start()
 {
     if(!running) {
         running = true;
+        ++count;
         started_at = cr::high_resolution_clock::now();
     }
 }
@@ -94,6 +99,15 @@ TimerEntry::duration_type Timer::getDuration(const std::string_view name) const
     return 0;
 }
 
+uint64_t Timer::getCount(const std::string_view name) const
+{
+    auto iter = timer_map.find(std::string(name));
+    if(iter != timer_map.end()) {
+        return iter->second.getCount();
+    }
+    return 0;
+}
+
 std::map<std::string, TimerEntry::duration_type> Timer::getDurations() const
 {
     std::map<std::string, TimerEntry::duration_type> entries;
@@ -57,6 +57,8 @@ public:
     // If the timer is still running, it returns the duration until now.
     // If the timer entry does not exist, it returns 0.
     duration_type getDurationInMicroseconds() const;
+    // Get how often the timer entry was started.
+    uint64_t getCount() const { return count; }
 
 private:
     // Last start time of the timer entry.
@@ -64,6 +66,8 @@ private:
     // Duration of the timer entry in microseconds.
     // It is updated with the time elapsed since the last start time when the timer is stopped.
     duration_type duration_in_microseconds{0};
+    // Number of times the timer entry was started.
+    uint64_t count{0};
     // Flag to indicate whether the timer is currently running or not.
     bool running{false};
 };
@@ -157,6 +161,9 @@ public:
     // If a timer entry does not exist, it is not included in the map.
     // PST: I choose a map here so that we always have the same order of entries when printing them.
     std::map<std::string, TimerEntry::duration_type> getDurations() const;
+    // Returns how often the timer probe with the given name was started, e.g. how often the
+    // timed code path was taken. If the timer entry does not exist, it returns 0.
+    uint64_t getCount(const std::string_view name) const;
     // Sets the log level for the timer. Timer probes with a log level higher than the set log
     // level will not be active and will not record time.
     void setLogLevel(int level) { max_log_level = level; };
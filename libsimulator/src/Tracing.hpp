@@ -15,6 +15,7 @@ PERFETTO_DEFINE_CATEGORIES(
 #define JPS_TRACE_EVENT(name) TRACE_EVENT("C++", name);
 #define JPS_TRACE_EVENT_BEGIN(name) TRACE_EVENT_BEGIN("C++", name)
 #define JPS_TRACE_EVENT_END TRACE_EVENT_END("C++")
+#define JPS_TRACE_COUNTER(name, value) TRACE_COUNTER("C++", name, value)
 #if defined(_MSC_VER)
 #define JPS_TRACE_FUNC JPS_TRACE_EVENT(__FUNCTION__)
 #else
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "WallDistanceField.hpp"
+
+#include "CollisionGeometry.hpp"
+#include "LineSegment.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+WallDistanceField::WallDistanceField(
+    const CollisionGeometry& geometry,
+    double resolution,
+    double maxDistance)
+    : _resolution(resolution), _maxDistance(maxDistance)
+{
+    if(resolution <= 0) {
+        throw SimulationError(
+            "Wall distance field resolution needs to be positive, got {}", resolution);
+    }
+    if(maxDistance <= 0) {
+        throw SimulationError(
+            "Wall distance field maximum distance needs to be positive, got {}", maxDistance);
+    }
+
+    const auto& bounds = geometry.Bounds();
+    _origin = bounds.BottomLeft();
+    _columns = std::max<size_t>(std::ceil((bounds.xmax - bounds.xmin) / resolution) + 1, 2);
+    _rows = std::max<size_t>(std::ceil((bounds.ymax - bounds.ymin) / resolution) + 1, 2);
+
+    const auto position = [this](size_t column, size_t row) {
+        return _origin + Point{column * _resolution, row * _resolution};
+    };
+    const auto toColumn = [this](double x) {
+        return static_cast<size_t>(std::clamp(
+            (x - _origin.x) / _resolution, 0., static_cast<double>(_columns - 1)));
+    };
+    const auto toRow = [this](double y) {
+        return static_cast<size_t>(
+            std::clamp((y - _origin.y) / _resolution, 0., static_cast<double>(_rows - 1)));
+    };
+
+    // Every linesegment updates the nodes within 'maxDistance' of its bounding box
+    std::vector<double> closestDistanceSquared(_columns * _rows, maxDistance * maxDistance);
+    std::vector<Point> closestPoint(_columns * _rows);
+    std::vector<bool> hasClosestPoint(_columns * _rows, false);
+    for(const auto& ls : geometry.LineSegments()) {
+        const auto firstColumn = toColumn(std::min(ls.p1.x, ls.p2.x) - maxDistance);
+        const auto lastColumn = toColumn(std::max(ls.p1.x, ls.p2.x) + maxDistance) + 1;
+        const auto firstRow = toRow(std::min(ls.p1.y, ls.p2.y) - maxDistance);
+        const auto lastRow = toRow(std::max(ls.p1.y, ls.p2.y) + maxDistance) + 1;
+        for(size_t row = firstRow; row <= std::min(lastRow, _rows - 1); ++row) {
+            for(size_t column = firstColumn; column <= std::min(lastColumn, _columns - 1);
+                ++column) {
+                const auto index = row * _columns + column;
+                const auto p = position(column, row);
+                const auto pt = ls.ShortestPoint(p);
+                const auto distanceSquared = (p - pt).NormSquare();
+                if(distanceSquared < closestDistanceSquared[index]) {
+                    closestDistanceSquared[index] = distanceSquared;
+                    closestPoint[index] = pt;
+                    hasClosestPoint[index] = true;
+                }
+            }
+        }
+    }
+
+    _nodes.resize(_columns * _rows);
+    for(size_t row = 0; row < _rows; ++row) {
+        for(size_t column = 0; column < _columns; ++column) {
+            const auto index = row * _columns + column;
+            const auto p = position(column, row);
+            auto& node = _nodes[index];
+            if(hasClosestPoint[index]) {
+                std::tie(node.distance, node.gradient) =
+                    (p - closestPoint[index]).NormAndNormalized();
+            } else {
+                node.distance = maxDistance;
+            }
+            if(!geometry.InsideGeometry(p)) {
+                node.distance = -node.distance;
+                node.gradient = -node.gradient;
+            }
+        }
+    }
+}
+
+WallDistanceField::Sample WallDistanceField::SampleAt(Point p) const
+{
+    const auto x =
+        std::clamp((p.x - _origin.x) / _resolution, 0., static_cast<double>(_columns - 1));
+    const auto y =
+        std::clamp((p.y - _origin.y) / _resolution, 0., static_cast<double>(_rows - 1));
+    const auto column = std::min(static_cast<size_t>(x), _columns - 2);
+    const auto row = std::min(static_cast<size_t>(y), _rows - 2);
+    const auto fx = x - column;
+    const auto fy = y - row;
+
+    const auto interpolate = [fx, fy](const auto& bottomLeft,
+                                      const auto& bottomRight,
+                                      const auto& topLeft,
+                                      const auto& topRight) {
+        return (bottomLeft * (1 - fx) + bottomRight * fx) * (1 - fy) +
+               (topLeft * (1 - fx) + topRight * fx) * fy;
+    };
+    const auto& bottomLeft = node(column, row);
+    const auto& bottomRight = node(column + 1, row);
+    const auto& topLeft = node(column, row + 1);
+    const auto& topRight = node(column + 1, row + 1);
+    return {
+        interpolate(
+            bottomLeft.distance, bottomRight.distance, topLeft.distance, topRight.distance),
+        interpolate(
+            bottomLeft.gradient, bottomRight.gradient, topLeft.gradient, topRight.gradient)};
+}
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "Point.hpp"
+
+#include <cstddef>
+#include <vector>
+
+class CollisionGeometry;
+
+/// Signed distance to the closest wall sampled on a regular grid over the bounds of a geometry.
+///
+/// Distances are positive inside and negative outside of the accessible area and are limited to
+/// 'maxDistance'. Nodes farther away from any wall have no gradient. Values between nodes are
+/// interpolated bilinearly, so the resolution should be well below the radius of an agent.
+class WallDistanceField
+{
+public:
+    struct Sample {
+        /// Distance to the closest wall, negative outside of the accessible area.
+        double distance{};
+        /// Gradient of 'distance', points away from the closest wall into the accessible area.
+        Point gradient{};
+    };
+
+private:
+    Point _origin{};
+    double _resolution{};
+    double _maxDistance{};
+    size_t _columns{};
+    size_t _rows{};
+    std::vector<Sample> _nodes{};
+
+public:
+    /// Samples the distance to the walls of 'geometry'.
+    /// @param geometry to sample
+    /// @param resolution distance between two nodes in meters
+    /// @param maxDistance distances are limited to this value in meters
+    WallDistanceField(const CollisionGeometry& geometry, double resolution, double maxDistance);
+
+    /// Bilinear interpolation of the distance field at 'p'. Points outside the bounds of the
+    /// geometry are clamped to the bounds.
+    /// @param p position to sample
+    /// @return distance and gradient at 'p'
+    Sample SampleAt(Point p) const;
+
+    double Resolution() const { return _resolution; }
+
+    double MaxDistance() const { return _maxDistance; }
+
+private:
+    const Sample& node(size_t column, size_t row) const { return _nodes[row * _columns + column]; }
+};
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentRemovalSystem.hpp"
+#include "GenericAgent.hpp"
+#include "Journey.hpp"
+#include "StageDescription.hpp"
+#include "StageManager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+class AgentRemovalSystemTest : public ::testing::Test
+{
+public:
+    StageManager stageManager{};
+    std::vector<GenericAgent::ID> removedAgentIds{};
+    AgentContainer<GenericAgent> agents{};
+    BaseStage::ID first{BaseStage::ID::Invalid};
+    BaseStage::ID second{BaseStage::ID::Invalid};
+
+    void SetUp() override
+    {
+        first = stageManager.AddStage(WaypointDescription{{0, 0}, 1}, removedAgentIds);
+        second = stageManager.AddStage(WaypointDescription{{5, 5}, 1}, removedAgentIds);
+        for(int index = 0; index < 10; ++index) {
+            const auto stageId = index % 3 == 0 ? second : first;
+            agents.emplace_back(
+                GenericAgent::ID::Invalid,
+                Journey::ID::Invalid,
+                stageId,
+                CollisionFreeSpeedModel::State{.position = {static_cast<double>(index), 0}});
+            stageManager.HandleNewAgent(stageId);
+        }
+    }
+
+    std::vector<GenericAgent::ID> Ids() const
+    {
+        std::vector<GenericAgent::ID> ids{};
+        for(const auto& agent : agents) {
+            ids.push_back(agent.id);
+        }
+        return ids;
+    }
+};
+
+TEST_F(AgentRemovalSystemTest, RemovesNothingWithoutIds)
+{
+    AgentRemovalSystem<GenericAgent> removalSystem{};
+    const auto expected = Ids();
+    ASSERT_EQ(removalSystem.Run(agents, removedAgentIds, stageManager), agents.size());
+    ASSERT_EQ(Ids(), expected);
+}
+
+TEST_F(AgentRemovalSystemTest, RemovesListedAgentsAndKeepsOrder)
+{
+    AgentRemovalSystem<GenericAgent> removalSystem{};
+    auto expected = Ids();
+    // Listed out of order and with a duplicate
+    removedAgentIds = {expected[6], expected[2], expected[3], expected[6]};
+    expected.erase(expected.begin() + 6);
+    expected.erase(expected.begin() + 3);
+    expected.erase(expected.begin() + 2);
+
+    ASSERT_EQ(removalSystem.Run(agents, removedAgentIds, stageManager), 2);
+    ASSERT_EQ(Ids(), expected);
+    ASSERT_TRUE(removedAgentIds.empty());
+    // Agent 2 targets the first stage, agents 3 and 6 the second one
+    ASSERT_EQ(stageManager.Stage(first)->CountTargeting(), 5);
+    ASSERT_EQ(stageManager.Stage(second)->CountTargeting(), 2);
+}
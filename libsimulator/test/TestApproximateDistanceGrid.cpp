@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "ApproximateDistanceGrid.hpp"
+
+#include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
+#include "Point.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <vector>
+
+static std::vector<LineSegment> denseSegments()
+{
+    // Many short walls in a 20 m x 20 m area, e.g. seats in a stadium
+    std::vector<LineSegment> segments{};
+    for(int row = 0; row < 40; ++row) {
+        for(int column = 0; column < 40; ++column) {
+            const Point p{column * 0.5, row * 0.5};
+            segments.push_back({p, p + Point{0.3, 0.1}});
+        }
+    }
+    return segments;
+}
+
+static std::vector<LineSegment> segmentsNear(const ApproximateDistanceGrid& grid, Point p)
+{
+    const auto segments = grid.SegmentsNear(p);
+    return {std::begin(segments), std::end(segments)};
+}
+
+TEST(ApproximateDistanceGrid, IsEmptyWithoutSegments)
+{
+    const ApproximateDistanceGrid grid({}, 4., 4.);
+    ASSERT_TRUE(grid.SegmentsNear({0., 0.}).empty());
+}
+
+/// Checks if all elements of 'sub' appear in 'sequence' in the same order.
+static bool
+isSubsequence(const std::vector<LineSegment>& sub, const std::vector<LineSegment>& sequence)
+{
+    auto it = std::begin(sequence);
+    for(const auto& ls : sub) {
+        it = std::find(it, std::end(sequence), ls);
+        if(it == std::end(sequence)) {
+            return false;
+        }
+        ++it;
+    }
+    return true;
+}
+
+TEST(ApproximateDistanceGrid, ListsSegmentsInRangeInInsertionOrder)
+{
+    const auto segments = denseSegments();
+    for(const auto cellSize : {1., 4.}) {
+        const ApproximateDistanceGrid grid(segments, cellSize, 4.);
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> coordinate(-6., 26.);
+        for(int i = 0; i < 2000; ++i) {
+            const Point p{coordinate(gen), coordinate(gen)};
+            const auto result = segmentsNear(grid, p);
+            std::vector<LineSegment> inRange{};
+            std::copy_if(
+                std::begin(segments),
+                std::end(segments),
+                std::back_inserter(inRange),
+                [p](const auto& ls) { return ls.DistTo(p) <= 4.; });
+            ASSERT_TRUE(isSubsequence(result, segments)) << p.x << ", " << p.y;
+            ASSERT_TRUE(isSubsequence(inRange, result)) << p.x << ", " << p.y;
+        }
+    }
+}
+
+TEST(ApproximateDistanceGrid, KeepsSparseCells)
+{
+    const std::vector<LineSegment> segments{{{0., 0.}, {10., 0.}}, {{10., 0.}, {10., 10.}}};
+    const ApproximateDistanceGrid grid(segments, 4., 4.);
+
+    // Base cells span [-4, 16) in both directions
+    ASSERT_EQ(grid.LeafCount(), 5 * 5);
+    ASSERT_EQ(segmentsNear(grid, {9., 1.}), segments);
+    ASSERT_TRUE(grid.SegmentsNear({-3., 15.}).empty());
+}
+
+TEST(ApproximateDistanceGrid, RefinesDenseCells)
+{
+    const auto segments = denseSegments();
+    const ApproximateDistanceGrid refined(segments, 4., 4.);
+
+    // Base cells span [-4, 28) in both directions
+    ASSERT_GT(refined.LeafCount(), 8 * 8);
+    // Close to a corner only a fraction of all segments can be in range
+    ASSERT_LT(refined.SegmentsNear({-3.9, -3.9}).size(), segments.size() / 4);
+}
+
+TEST(ApproximateDistanceGrid, BlockListsSameSegments)
+{
+    const auto segments = denseSegments();
+    const ApproximateDistanceGrid grid(segments, 4., 4.);
+
+    ClosestPoints closest{};
+    for(const Point p : {Point{-3.9, -3.9}, Point{10., 10.}, Point{25., 1.}}) {
+        const auto expected = segmentsNear(grid, p);
+        grid.BlockNear(p).ClosestPointsTo(p, closest);
+        ASSERT_EQ(closest.Size(), expected.size());
+        for(size_t index = 0; index < expected.size(); ++index) {
+            ASSERT_EQ(closest.At(index), expected[index].ShortestPoint(p));
+        }
+    }
+}
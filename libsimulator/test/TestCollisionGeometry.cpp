@@ -1,143 +1,23 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "CollisionGeometry.hpp"
+#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
+#include "SimulationError.hpp"
 #include "gtest/gtest.h"
 
+#include <CGAL/Boolean_set_operations_2/oriented_side.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <gtest/gtest.h>
 
-struct CellAdjacencyTestData {
-    Cell c;
-    Cell neighbor;
-    bool expected;
-};
-
-class CellAdjacencyTest : public ::testing::TestWithParam<CellAdjacencyTestData>
-{
-};
-
-TEST_P(CellAdjacencyTest, All)
-{
-    const auto [c, neighbor, expected] = GetParam();
-    EXPECT_EQ(IsN8Adjacent(c, neighbor), expected);
-    EXPECT_EQ(IsN8Adjacent(neighbor, c), expected);
-}
-
-// clang-format off
-INSTANTIATE_TEST_SUITE_P(
-    CellNeighborhood,
-    CellAdjacencyTest,
-    testing::Values(
-        // A cell is not a neighbor of itself
-        CellAdjacencyTestData{{0, 0}, {0, 0}, false},
-        // N4 neigbors
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND, 0}, true},
-        CellAdjacencyTestData{{0, 0}, {0, CELL_EXTEND}, true},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND, CELL_EXTEND}, true},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND, 0}, true},
-        CellAdjacencyTestData{{0, 0}, {0, -CELL_EXTEND}, true},
-        // N8 neighbors
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND, -CELL_EXTEND}, true},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND, -CELL_EXTEND}, true},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND, CELL_EXTEND}, true},
-        // Layer beyond N8 (all false, no direct neighbors)
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND*2, 0}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND*2, CELL_EXTEND}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND*2, CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND, CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {0, CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND, CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND*2, CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND*2, CELL_EXTEND}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND*2, 0}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND*2, -CELL_EXTEND}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND*2, -CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {-CELL_EXTEND, -CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {0, -CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND, -CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND*2, -CELL_EXTEND*2}, false},
-        CellAdjacencyTestData{{0, 0}, {CELL_EXTEND*2, -CELL_EXTEND}, false}
-    )
-);
-// clang-format on
-
-class CellsFromLSTest : public ::testing::TestWithParam<std::tuple<LineSegment, std::set<Cell>>>
-{
-};
-
-TEST_P(CellsFromLSTest, All)
-{
-    const auto [input, expected] = GetParam();
-    const LineSegment reverseInput{input.p2, input.p1};
-    EXPECT_EQ(expected, cellsFromLineSegment(input));
-    EXPECT_EQ(expected, cellsFromLineSegment(reverseInput));
-}
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
 
-// clang-format off
-INSTANTIATE_TEST_SUITE_P(
-    CellComputation,
-    CellsFromLSTest,
-    testing::Values(
-        std::make_tuple(
-            LineSegment{{0, 0}, {0, 0}},
-            std::set<Cell>{{0, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{1, 0}, {0, 0}},
-            std::set<Cell>{{0, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 1}, {0, 0}},
-            std::set<Cell>{{0, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {1, 1}},
-            std::set<Cell>{{0, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{1, 3}, {11, 5}},
-            std::set<Cell>{{0,0}, {4, 0}, {4, 4}, {8, 4}}
-        ),
-        std::make_tuple(
-            LineSegment{{-3, 0}, {6, 0}},
-            std::set<Cell>{{-4, 0}, {0, 0}, {4, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {-7, -7}},
-            std::set<Cell>{{-8,-8},{0, 0}, {-4, -4}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {7, 7}},
-            std::set<Cell>{{0, 0}, {4, 4}}
-        ),
-        std::make_tuple(
-            LineSegment{{1, 1}, {3, 4}},
-            std::set<Cell>{{0, 0}, {0, 4}}
-        ),
-        std::make_tuple(
-            LineSegment{{4, 12}, {8, 0}},
-            std::set<Cell>{{4, 12}, {4, 8}, {4,4}, {4,0}, {8,0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {0, 8}},
-            std::set<Cell>{{0, 0}, {0, 4}, {0, 8}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {8, 0}},
-            std::set<Cell>{{0, 0}, {4, 0}, {8, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {0, 0}},
-            std::set<Cell>{{0, 0}}
-        ),
-        std::make_tuple(
-            LineSegment{{0, 0}, {0, 0}},
-            std::set<Cell>{{0, 0}}
-        )
-    )
-);
-// clang-format on
+/// Cell size of the geometry grids in the tests below.
+constexpr double CELL_SIZE = 4.;
 
 PolyWithHoles constructPolyFromPoints(const std::vector<Point>& points)
 {
@@ -157,7 +37,9 @@ protected:
     CollisionGeometry collisionGeometry;
 
     ApproximateDistanceSimpleRectangle()
-        : collisionGeometry(constructPolyFromPoints({{1., 1.}, {3., 1.}, {3., 3.}, {1., 3.}}))
+        : collisionGeometry(
+              constructPolyFromPoints({{1., 1.}, {3., 1.}, {3., 3.}, {1., 3.}}),
+              CELL_SIZE)
     {
     }
 };
@@ -186,16 +68,16 @@ TEST_F(ApproximateDistanceSimpleRectangle, outsideInRange)
         {{1., 3.}, {1., 1.}},
     };
 
-    const std::vector<Cell> candidates = {
-        {-CELL_EXTEND, -CELL_EXTEND},
-        {-CELL_EXTEND, 0},
-        {-CELL_EXTEND, CELL_EXTEND},
-        {0, -CELL_EXTEND},
+    const std::vector<Point> candidates = {
+        {-CELL_SIZE, -CELL_SIZE},
+        {-CELL_SIZE, 0},
+        {-CELL_SIZE, CELL_SIZE},
+        {0, -CELL_SIZE},
         {0, 0},
-        {0, CELL_EXTEND},
-        {CELL_EXTEND, -CELL_EXTEND},
-        {CELL_EXTEND, 0},
-        {CELL_EXTEND, CELL_EXTEND}};
+        {0, CELL_SIZE},
+        {CELL_SIZE, -CELL_SIZE},
+        {CELL_SIZE, 0},
+        {CELL_SIZE, CELL_SIZE}};
 
     for(const auto& point : candidates) {
         const auto result = collisionGeometry.LineSegmentsInApproxDistanceTo(point);
@@ -212,14 +94,15 @@ protected:
 
     LongDiagonalRectangle()
         : collisionGeometry(
-              constructPolyFromPoints({{-11., -13.}, {5., 11.}, {6., 10.}, {-10., -14.}}))
+              constructPolyFromPoints({{-11., -13.}, {5., 11.}, {6., 10.}, {-10., -14.}}),
+              CELL_SIZE)
     {
     }
 };
 
 TEST_F(LongDiagonalRectangle, FarCellsOutside)
 {
-    const std::vector<Cell> candidates = {
+    const std::vector<Point> candidates = {
         {-16., -4}, {-16, 0}, {-16, 4}, {-16, 8},  {-16, 12}, {-12, 4}, {-12, 8},
         {-12, 12},  {-8, 8},  {-8, 12}, {-4, -20}, {0, -16},  {4, -20}, {4, -16},
         {4, -12},   {4, -8},  {8, -20}, {8, -16},  {8, -12},  {8, -8},  {8, -4}};
@@ -235,17 +118,17 @@ TEST_F(LongDiagonalRectangle, CellsAtBottomLeft)
     const std::set<LineSegment> expected = {
         {{-11., -13.}, {5., 11.}}, {{6., 10.}, {-10., -14.}}, {{-10., -14.}, {-11., -13.}}};
 
-    const auto middleCell = Cell{-12, -16};
-    const std::vector<Cell> candidates = {
-        {middleCell.x - CELL_EXTEND, middleCell.y - CELL_EXTEND},
-        {middleCell.x - CELL_EXTEND, middleCell.y},
-        {middleCell.x - CELL_EXTEND, middleCell.y + CELL_EXTEND},
-        {middleCell.x, middleCell.y - CELL_EXTEND},
+    const auto middleCell = Point{-12, -16};
+    const std::vector<Point> candidates = {
+        {middleCell.x - CELL_SIZE, middleCell.y - CELL_SIZE},
+        {middleCell.x - CELL_SIZE, middleCell.y},
+        {middleCell.x - CELL_SIZE, middleCell.y + CELL_SIZE},
+        {middleCell.x, middleCell.y - CELL_SIZE},
         {middleCell.x, middleCell.y},
-        {middleCell.x, middleCell.y + CELL_EXTEND},
-        {middleCell.x + CELL_EXTEND, middleCell.y - CELL_EXTEND},
-        {middleCell.x + CELL_EXTEND, middleCell.y},
-        {middleCell.x + CELL_EXTEND, middleCell.y + CELL_EXTEND}};
+        {middleCell.x, middleCell.y + CELL_SIZE},
+        {middleCell.x + CELL_SIZE, middleCell.y - CELL_SIZE},
+        {middleCell.x + CELL_SIZE, middleCell.y},
+        {middleCell.x + CELL_SIZE, middleCell.y + CELL_SIZE}};
 
     for(const auto& point : candidates) {
         const auto result = collisionGeometry.LineSegmentsInApproxDistanceTo(point);
@@ -260,17 +143,17 @@ TEST_F(LongDiagonalRectangle, CellsAtTopRight)
     const std::set<LineSegment> expected = {
         {{-11., -13.}, {5., 11.}}, {{5., 11.}, {6., 10.}}, {{6., 10.}, {-10., -14.}}};
 
-    const auto middleCell = Cell{4, 8};
-    const std::vector<Cell> candidates = {
-        {middleCell.x - CELL_EXTEND, middleCell.y - CELL_EXTEND},
-        {middleCell.x - CELL_EXTEND, middleCell.y},
-        {middleCell.x - CELL_EXTEND, middleCell.y + CELL_EXTEND},
-        {middleCell.x, middleCell.y - CELL_EXTEND},
+    const auto middleCell = Point{4, 8};
+    const std::vector<Point> candidates = {
+        {middleCell.x - CELL_SIZE, middleCell.y - CELL_SIZE},
+        {middleCell.x - CELL_SIZE, middleCell.y},
+        {middleCell.x - CELL_SIZE, middleCell.y + CELL_SIZE},
+        {middleCell.x, middleCell.y - CELL_SIZE},
         {middleCell.x, middleCell.y},
-        {middleCell.x, middleCell.y + CELL_EXTEND},
-        {middleCell.x + CELL_EXTEND, middleCell.y - CELL_EXTEND},
-        {middleCell.x + CELL_EXTEND, middleCell.y},
-        {middleCell.x + CELL_EXTEND, middleCell.y + CELL_EXTEND}};
+        {middleCell.x, middleCell.y + CELL_SIZE},
+        {middleCell.x + CELL_SIZE, middleCell.y - CELL_SIZE},
+        {middleCell.x + CELL_SIZE, middleCell.y},
+        {middleCell.x + CELL_SIZE, middleCell.y + CELL_SIZE}};
 
     for(const auto& point : candidates) {
         const auto result = collisionGeometry.LineSegmentsInApproxDistanceTo(point);
@@ -284,7 +167,7 @@ TEST_F(LongDiagonalRectangle, CellsWithOneLSLeft)
 {
     const std::set<LineSegment> expected = {{{-11., -13.}, {5., 11.}}};
 
-    const std::vector<Cell> candidates = {{-12, 0}, {-4, 12}};
+    const std::vector<Point> candidates = {{-12, 0}, {-4, 12}};
 
     for(const auto& point : candidates) {
         const auto result = collisionGeometry.LineSegmentsInApproxDistanceTo(point);
@@ -298,7 +181,7 @@ TEST_F(LongDiagonalRectangle, CellsWithOneLSRight)
 {
     const std::set<LineSegment> expected = {{{6., 10.}, {-10., -14.}}};
 
-    const std::vector<Cell> candidates = {{0, -12}, {8, 0}};
+    const std::vector<Point> candidates = {{0, -12}, {8, 0}};
 
     for(const auto& point : candidates) {
         const auto result = collisionGeometry.LineSegmentsInApproxDistanceTo(point);
@@ -312,7 +195,7 @@ TEST_F(LongDiagonalRectangle, CellsWithTwoLSMiddle)
 {
     const std::set<LineSegment> expected = {{{-11., -13.}, {5., 11.}}, {{6., 10.}, {-10., -14.}}};
 
-    const std::vector<Cell> candidates = {
+    const std::vector<Point> candidates = {
         {-16, -8}, {-12, -8}, {-12, -4}, {-8, -8}, {-8, -4}, {-8, 0}, {-8, 4},
         {-4, -16}, {-4, -12}, {-4, -8},  {-4, -4}, {-4, 0},  {-4, 4}, {-4, 8},
         {0, -8},   {0, -4},   {0, 0},    {4, -4},  {4, 0},
@@ -325,3 +208,150 @@ TEST_F(LongDiagonalRectangle, CellsWithTwoLSMiddle)
         ASSERT_EQ(actual, expected);
     }
 }
+
+TEST_F(LongDiagonalRectangle, LineSegmentsInDistanceToMatchesLinearScan)
+{
+    const std::vector<LineSegment> segments = {
+        {{-11., -13.}, {5., 11.}},
+        {{5., 11.}, {6., 10.}},
+        {{6., 10.}, {-10., -14.}},
+        {{-10., -14.}, {-11., -13.}}};
+
+    for(double distance : {0.1, 1., 3., 7., 50.}) {
+        for(double x = -20.; x <= 15.; x += 0.7) {
+            for(double y = -20.; y <= 15.; y += 0.7) {
+                const Point p{x, y};
+                std::vector<LineSegment> expected{};
+                std::copy_if(
+                    std::begin(segments),
+                    std::end(segments),
+                    std::back_inserter(expected),
+                    [distance, p](const auto& ls) { return ls.DistTo(p) <= distance; });
+
+                ASSERT_EQ(collisionGeometry.LineSegmentsInDistanceTo(distance, p), expected);
+            }
+        }
+    }
+}
+
+TEST(InsideGeometry, MatchesPolygonTest)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> exterior{{0., 0.}, {10., 0.}, {10., 3.7}, {4.3, 3.7}, {0., 10.}};
+    const std::vector<CGALPoint> hole{{1., 1.}, {2.1, 1.}, {1.55, 2.33}};
+    const std::vector<Poly> holes{Poly{hole.begin(), hole.end()}};
+    const PolyWithHoles polygon(Poly{exterior.begin(), exterior.end()}, holes.begin(), holes.end());
+    const CollisionGeometry collisionGeometry(polygon);
+
+    for(double x = -1.; x <= 11.; x += 0.037) {
+        for(double y = -1.; y <= 11.; y += 0.037) {
+            const auto expected =
+                CGAL::oriented_side(CGALPoint{x, y}, polygon) != CGAL::ON_NEGATIVE_SIDE;
+            ASSERT_EQ(collisionGeometry.InsideGeometry({x, y}), expected) << x << ", " << y;
+        }
+    }
+    for(const auto& p : exterior) {
+        ASSERT_TRUE(collisionGeometry.InsideGeometry({p.x(), p.y()}));
+    }
+    for(const auto& p : hole) {
+        ASSERT_TRUE(collisionGeometry.InsideGeometry({p.x(), p.y()}));
+    }
+}
+
+TEST(InsideGeometry, PointsNearWallsMatchPolygonTest)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> exterior{{0., 0.}, {10., 0.}, {10., 3.7}, {4.3, 3.7}, {0., 10.}};
+    const PolyWithHoles polygon(Poly{exterior.begin(), exterior.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+
+    // Points on the slanted wall and within rounding distance of it on either side
+    for(double t = 0.; t <= 1.; t += 0.0123) {
+        const double x = 4.3 - 4.3 * t;
+        const double y = 3.7 + 6.3 * t;
+        for(const double offset : {-1e-12, -1e-15, 0., 1e-15, 1e-12}) {
+            const auto expected = CGAL::oriented_side(CGALPoint{x + offset, y}, polygon) !=
+                                  CGAL::ON_NEGATIVE_SIDE;
+            ASSERT_EQ(collisionGeometry.InsideGeometry({x + offset, y}), expected)
+                << x + offset << ", " << y;
+        }
+    }
+}
+
+TEST_F(LongDiagonalRectangle, IntersectsAnyMatchesLinearScan)
+{
+    const std::vector<LineSegment> segments = {
+        {{-11., -13.}, {5., 11.}},
+        {{5., 11.}, {6., 10.}},
+        {{6., 10.}, {-10., -14.}},
+        {{-10., -14.}, {-11., -13.}}};
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coordinate(-20., 15.);
+    for(int i = 0; i < 10000; ++i) {
+        const LineSegment ls{
+            {coordinate(gen), coordinate(gen)}, {coordinate(gen), coordinate(gen)}};
+        const auto expected = std::any_of(
+            std::begin(segments), std::end(segments), [&ls](const auto& segment) {
+                return intersects(ls, segment);
+            });
+        ASSERT_EQ(collisionGeometry.IntersectsAny(ls), expected);
+    }
+}
+
+TEST(CollisionGeometryCellSize, IsChosenFromSegmentDensity)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> room{{0., 0.}, {100., 0.}, {100., 100.}, {0., 100.}};
+    ASSERT_EQ(CollisionGeometry(PolyWithHoles(Poly{room.begin(), room.end()})).CellSize(), 4.);
+
+    std::vector<CGALPoint> comb{};
+    for(int tooth = 0; tooth < 50; ++tooth) {
+        comb.emplace_back(tooth * 0.2, 0.);
+        comb.emplace_back(tooth * 0.2 + 0.1, 1.);
+    }
+    comb.emplace_back(10., 0.);
+    comb.emplace_back(10., -1.);
+    comb.emplace_back(0., -1.);
+    const auto cellSize =
+        CollisionGeometry(PolyWithHoles(Poly{comb.begin(), comb.end()})).CellSize();
+    ASSERT_GE(cellSize, 1.);
+    ASSERT_LT(cellSize, 4.);
+}
+
+TEST(CollisionGeometryCellSize, CanBeSetExplicitly)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> room{{0., 0.}, {100., 0.}, {100., 100.}, {0., 100.}};
+    const PolyWithHoles polygon(Poly{room.begin(), room.end()});
+    ASSERT_EQ(CollisionGeometry(polygon, 2.5).CellSize(), 2.5);
+    ASSERT_THROW(CollisionGeometry(polygon, -1.), SimulationError);
+}
+
+TEST(CollisionGeometryIdentity, WktHasClosedRings)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> room{{0., 0.}, {10., 0.}, {10., 10.5}, {0., 10.5}};
+    const std::vector<CGALPoint> pillar{{2., 2.}, {2., 3.}, {3., 3.}, {3., 2.}};
+    const std::vector<Poly> holes{Poly{pillar.begin(), pillar.end()}};
+    const CollisionGeometry geometry(
+        PolyWithHoles(Poly{room.begin(), room.end()}, holes.begin(), holes.end()));
+    ASSERT_EQ(
+        geometry.Wkt(),
+        "POLYGON ((0 0, 10 0, 10 10.5, 0 10.5, 0 0), (2 2, 2 3, 3 3, 3 2, 2 2))");
+}
+
+TEST(CollisionGeometryIdentity, HashIdentifiesAccessibleArea)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> room{{0., 0.}, {10., 0.}, {10., 10.}, {0., 10.}};
+    const std::vector<CGALPoint> largerRoom{{0., 0.}, {11., 0.}, {11., 10.}, {0., 10.}};
+    const CollisionGeometry geometry(PolyWithHoles(Poly{room.begin(), room.end()}));
+    const auto copy = geometry;
+
+    ASSERT_EQ(copy.Hash(), geometry.Hash());
+    ASSERT_EQ(CollisionGeometry(PolyWithHoles(Poly{room.begin(), room.end()}), 2.).Hash(),
+              geometry.Hash());
+    ASSERT_NE(CollisionGeometry(PolyWithHoles(Poly{largerRoom.begin(), largerRoom.end()})).Hash(),
+              geometry.Hash());
+}
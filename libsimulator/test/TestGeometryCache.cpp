@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "GeometryCache.hpp"
+
+#include "CfgCgal.hpp"
+#include "GeometryHash.hpp"
+#include "Mesh.hpp"
+#include "Point.hpp"
+#include "RoutingEngine.hpp"
+#include "SimulationError.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+PolyWithHoles bottleneck()
+{
+    const std::vector<K::Point_2> boundary{
+        {0, 0}, {10, 0}, {10, 4.6}, {15, 4.6}, {15, 0}, {25, 0}, {25, 10}, {15, 10}, {15, 5.4},
+        {10, 5.4}, {10, 10}, {0, 10}};
+    const std::vector<K::Point_2> hole{{2, 2}, {2, 3}, {3, 3}, {3, 2}};
+    const std::vector<Poly> holes{Poly(std::begin(hole), std::end(hole))};
+    return PolyWithHoles(
+        Poly(std::begin(boundary), std::end(boundary)), std::begin(holes), std::end(holes));
+}
+
+PolyWithHoles square(double size)
+{
+    const std::vector<K::Point_2> boundary{{0, 0}, {size, 0}, {size, size}, {0, size}};
+    return PolyWithHoles(Poly(std::begin(boundary), std::end(boundary)));
+}
+
+std::string serialized(const PolyWithHoles& poly)
+{
+    std::stringstream data{};
+    WriteRoutingData(data, poly, RoutingEngine(poly));
+    return data.str();
+}
+} // namespace
+
+TEST(GeometryHash, DependsOnEveryCoordinate)
+{
+    const auto reference = GeometryHash(square(10));
+    EXPECT_EQ(GeometryHash(square(10)), reference);
+    EXPECT_NE(GeometryHash(square(10.000000001)), reference);
+    EXPECT_NE(GeometryHash(bottleneck()), reference);
+}
+
+TEST(GeometryCache, RoundTripKeepsMeshAndRoutes)
+{
+    const auto poly = bottleneck();
+    RoutingEngine built(poly);
+    std::stringstream data{serialized(poly)};
+    const auto read = ReadRoutingData(data, poly);
+    ASSERT_NE(read, nullptr);
+
+    const auto* expected = built.MeshData();
+    const auto* actual = read->MeshData();
+    ASSERT_EQ(actual->CountVertices(), expected->CountVertices());
+    for(size_t index = 0; index < expected->CountVertices(); ++index) {
+        EXPECT_EQ(actual->Vertex(index), expected->Vertex(index));
+    }
+    ASSERT_EQ(actual->CountPolygons(), expected->CountPolygons());
+    for(size_t index = 0; index < expected->CountPolygons(); ++index) {
+        EXPECT_EQ(actual->Polygons(index).vertices, expected->Polygons(index).vertices);
+        EXPECT_EQ(actual->Polygons(index).neighbors, expected->Polygons(index).neighbors);
+    }
+
+    for(const auto& [from, to] : std::vector<std::pair<Point, Point>>{
+            {{1, 1}, {24, 9}}, {{5, 9}, {20, 1}}, {{1, 5}, {4, 2.5}}}) {
+        EXPECT_EQ(read->ComputeAllWaypoints(from, to), built.ComputeAllWaypoints(from, to));
+        EXPECT_EQ(read->IsRoutable(from), built.IsRoutable(from));
+    }
+}
+
+TEST(GeometryCache, RejectsDataOfOtherGeometry)
+{
+    std::stringstream data{serialized(square(10))};
+    EXPECT_EQ(ReadRoutingData(data, square(11)), nullptr);
+}
+
+TEST(GeometryCache, RejectsDamagedData)
+{
+    const auto poly = square(10);
+    const auto complete = serialized(poly);
+    for(const auto length : {size_t{0}, size_t{4}, complete.size() / 2, complete.size() - 1}) {
+        std::stringstream data{complete.substr(0, length)};
+        EXPECT_EQ(ReadRoutingData(data, poly), nullptr) << "truncated to " << length;
+    }
+    auto wrongVersion = complete;
+    wrongVersion[4] = static_cast<char>(wrongVersion[4] + 1);
+    std::stringstream data{wrongVersion};
+    EXPECT_EQ(ReadRoutingData(data, poly), nullptr);
+}
+
+TEST(GeometryCache, StoresOnMissAndLoadsOnHit)
+{
+    const auto directory =
+        std::filesystem::temp_directory_path() / "jupedsim-test-geometry-cache" / "nested";
+    std::filesystem::remove_all(directory.parent_path());
+    const GeometryCache cache(directory);
+    const auto poly = bottleneck();
+
+    EXPECT_EQ(cache.Load(poly), nullptr);
+    ASSERT_NE(cache.LoadOrBuild(poly), nullptr);
+    EXPECT_TRUE(std::filesystem::exists(cache.FileFor(poly)));
+    EXPECT_NE(cache.Load(poly), nullptr);
+    EXPECT_EQ(std::distance(
+                  std::filesystem::directory_iterator(directory),
+                  std::filesystem::directory_iterator()),
+              1);
+
+    std::ofstream(cache.FileFor(poly), std::ios::binary | std::ios::trunc) << "garbage";
+    EXPECT_EQ(cache.Load(poly), nullptr);
+    EXPECT_NE(cache.LoadOrBuild(poly), nullptr);
+    EXPECT_NE(cache.Load(poly), nullptr);
+
+    std::filesystem::remove_all(directory.parent_path());
+}
+
+TEST(GeometryCache, BuildsWhenDirectoryIsNotWritable)
+{
+    // A file in place of a parent directory makes the cache directory impossible to create, even
+    // for users that may write everywhere
+    const auto blocker = std::filesystem::temp_directory_path() / "jupedsim-test-geometry-blocker";
+    std::filesystem::remove_all(blocker);
+    std::ofstream(blocker) << "not a directory";
+    const GeometryCache cache(blocker / "cache");
+    const auto poly = bottleneck();
+
+    EXPECT_THROW(cache.Store(poly, RoutingEngine(poly)), SimulationError);
+    EXPECT_NE(cache.LoadOrBuild(poly), nullptr);
+    EXPECT_FALSE(std::filesystem::exists(cache.FileFor(poly)));
+
+    std::filesystem::remove_all(blocker);
+}
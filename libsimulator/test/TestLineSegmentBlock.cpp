@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "LineSegmentBlock.hpp"
+
+#include "LineSegment.hpp"
+#include "Point.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+using InstructionSet = LineSegmentBlock::InstructionSet;
+
+static std::vector<InstructionSet> supportedInstructionSets()
+{
+    std::vector<InstructionSet> result{};
+    for(const auto instructionSet :
+        {InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2}) {
+        if(LineSegmentBlock::IsSupported(instructionSet)) {
+            result.push_back(instructionSet);
+        }
+    }
+    return result;
+}
+
+TEST(LineSegmentBlock, ScalarIsAlwaysSupported)
+{
+    ASSERT_TRUE(LineSegmentBlock::IsSupported(InstructionSet::Scalar));
+    ASSERT_TRUE(LineSegmentBlock::IsSupported(LineSegmentBlock::SupportedInstructionSet()));
+}
+
+TEST(LineSegmentBlock, EmptyBlockHasNoClosestPoints)
+{
+    ClosestPoints result{};
+    result.distance.push_back(1.);
+    LineSegmentBlock{}.ClosestPointsTo({1., 2.}, result);
+    ASSERT_EQ(result.Size(), 0);
+}
+
+TEST(LineSegmentBlock, MatchesShortestPointExactly)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coordinate(-10., 10.);
+    std::uniform_int_distribution<int> integer(-3, 3);
+
+    // Every block size up to 19 covers all remainders of the vector kernels
+    for(size_t size = 0; size < 20; ++size) {
+        std::vector<LineSegment> segments{};
+        for(size_t index = 0; index < size; ++index) {
+            if(index % 5 == 0) {
+                // Degenerate linesegment
+                const Point p{coordinate(gen), coordinate(gen)};
+                segments.emplace_back(p, p);
+            } else if(index % 5 == 1) {
+                // Integer coordinates to hit the end points exactly
+                segments.emplace_back(
+                    Point(integer(gen), integer(gen)), Point(integer(gen), integer(gen)));
+            } else {
+                segments.emplace_back(
+                    Point(coordinate(gen), coordinate(gen)),
+                    Point(coordinate(gen), coordinate(gen)));
+            }
+        }
+        const LineSegmentBlock block(segments);
+        ASSERT_EQ(block.Size(), size);
+
+        for(int i = 0; i < 100; ++i) {
+            const Point p = i % 2 == 0 ? Point(coordinate(gen), coordinate(gen)) :
+                                         Point(integer(gen), integer(gen));
+            for(const auto instructionSet : supportedInstructionSets()) {
+                ClosestPoints result{};
+                block.ClosestPointsTo(p, result, instructionSet);
+                ASSERT_EQ(result.Size(), size);
+                for(size_t index = 0; index < size; ++index) {
+                    const auto expected = segments[index].ShortestPoint(p);
+                    ASSERT_EQ(result.At(index), expected) << static_cast<int>(instructionSet);
+                    ASSERT_EQ(result.distance[index], (expected - p).Norm());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "LineSegment.hpp"
+#include "LineSegmentGrid.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using GridCell = std::pair<int64_t, int64_t>;
+
+static std::vector<GridCell> cellsAlong(const LineSegment& ls, double cellSize)
+{
+    std::vector<GridCell> cells{};
+    LineSegmentGrid::ForEachCellAlong(ls, cellSize, [&cells](int64_t column, int64_t row) {
+        cells.emplace_back(column, row);
+        return false;
+    });
+    return cells;
+}
+
+TEST(LineSegmentGrid, WalkConnectsEndpointCells)
+{
+    constexpr double cellSize = 1.5;
+    const auto cellOf = [](Point p) {
+        return GridCell{std::floor(p.x / cellSize), std::floor(p.y / cellSize)};
+    };
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coordinate(-20., 20.);
+    for(int i = 0; i < 1000; ++i) {
+        const LineSegment ls{
+            {coordinate(gen), coordinate(gen)}, {coordinate(gen), coordinate(gen)}};
+        const auto cells = cellsAlong(ls, cellSize);
+        ASSERT_EQ(cells.front(), cellOf(ls.p1));
+        ASSERT_EQ(cells.back(), cellOf(ls.p2));
+        ASSERT_EQ(std::set<GridCell>(cells.begin(), cells.end()).size(), cells.size());
+        for(size_t index = 1; index < cells.size(); ++index) {
+            const auto dColumn = std::abs(cells[index].first - cells[index - 1].first);
+            const auto dRow = std::abs(cells[index].second - cells[index - 1].second);
+            ASSERT_LE(dColumn, 1);
+            ASSERT_LE(dRow, 1);
+        }
+    }
+}
+
+TEST(LineSegmentGrid, WalkThroughCornerVisitsCornerCell)
+{
+    // The corner (2, 2) belongs to cell (1, 1)
+    const std::vector<GridCell> expected{{0, 1}, {1, 1}, {1, 0}};
+    ASSERT_EQ(cellsAlong({{1, 3}, {3, 1}}, 2.), expected);
+    const std::vector<GridCell> expectedReverse{{1, 0}, {1, 1}, {0, 1}};
+    ASSERT_EQ(cellsAlong({{3, 1}, {1, 3}}, 2.), expectedReverse);
+    const std::vector<GridCell> expectedDiagonal{{0, 0}, {1, 1}};
+    ASSERT_EQ(cellsAlong({{1, 1}, {3, 3}}, 2.), expectedDiagonal);
+}
+
+TEST(LineSegmentGrid, WalkStopsEarly)
+{
+    size_t visited = 0;
+    const auto stopped = LineSegmentGrid::ForEachCellAlong(
+        {{0.5, 0.5}, {9.5, 0.5}}, 1., [&visited](int64_t column, int64_t) {
+            ++visited;
+            return column == 3;
+        });
+    ASSERT_TRUE(stopped);
+    ASSERT_EQ(visited, 4);
+}
+
+TEST(LineSegmentGrid, ListsSegmentsPerCell)
+{
+    const std::vector<LineSegment> segments{
+        {{0.5, 0.5}, {3.5, 0.5}}, {{3.5, 0.5}, {3.5, 3.5}}, {{-0.5, -0.5}, {0.5, 0.5}}};
+    const LineSegmentGrid grid(segments, 1.);
+    ASSERT_EQ(grid.CellCount(), 25);
+
+    const auto cell = [&grid](int64_t column, int64_t row) {
+        const auto range = grid.SegmentsInCell(column, row);
+        return std::vector<uint32_t>(range.begin(), range.end());
+    };
+    ASSERT_EQ(cell(0, 0), (std::vector<uint32_t>{0, 2}));
+    ASSERT_EQ(cell(3, 0), (std::vector<uint32_t>{0, 1}));
+    ASSERT_EQ(cell(3, 2), (std::vector<uint32_t>{1}));
+    ASSERT_EQ(cell(-1, -1), (std::vector<uint32_t>{2}));
+    ASSERT_TRUE(cell(1, 1).empty());
+    ASSERT_TRUE(cell(10, 0).empty());
+    ASSERT_TRUE(cell(-2, 0).empty());
+}
@@ -6,6 +6,9 @@
 #include <glm/vec2.hpp>
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <vector>
+
 class SingleTriangeMesh : public ::testing::Test
 {
 public:
@@ -82,3 +85,72 @@ TEST_F(DoubleBottleNeckMesh, RegressionInContains)
         m->FindContainingPolygon({26.690912185191067, 4.94908998002494}),
         Mesh::Polygon::InvalidIndex);
 }
+
+namespace
+{
+// Rectangle of 'columns' x 'rows' unit squares, each split into two triangles
+Mesh gridMesh(size_t columns, size_t rows)
+{
+    std::vector<glm::dvec2> vertices{};
+    for(size_t y = 0; y <= rows; ++y) {
+        for(size_t x = 0; x <= columns; ++x) {
+            vertices.emplace_back(x, y);
+        }
+    }
+    const auto vertex = [columns](size_t x, size_t y) { return y * (columns + 1) + x; };
+    const auto lower = [columns](size_t x, size_t y) { return 2 * (y * columns + x); };
+    constexpr auto X = Mesh::Polygon::InvalidIndex;
+    std::vector<Mesh::Polygon> polygons{};
+    for(size_t y = 0; y < rows; ++y) {
+        for(size_t x = 0; x < columns; ++x) {
+            polygons.push_back(
+                {{vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1)},
+                 {y > 0 ? lower(x, y - 1) + 1 : X,
+                  x + 1 < columns ? lower(x + 1, y) + 1 : X,
+                  lower(x, y) + 1}});
+            polygons.push_back(
+                {{vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1)},
+                 {lower(x, y), y + 1 < rows ? lower(x, y + 1) : X, x > 0 ? lower(x - 1, y) : X}});
+        }
+    }
+    return Mesh(std::move(vertices), std::move(polygons));
+}
+
+// The first polygon containing 'p' as found by testing every polygon
+size_t findContainingPolygonLinear(const Mesh& mesh, glm::dvec2 p)
+{
+    for(size_t index = 0; index < mesh.CountPolygons(); ++index) {
+        if(mesh.AxisAlignedBoundingBox(index).Inside({p.x, p.y}) &&
+           mesh.PolygonContains(index, p)) {
+            return index;
+        }
+    }
+    return Mesh::Polygon::InvalidIndex;
+}
+} // namespace
+
+TEST(Mesh, FindContainingPolygonMatchesLinearSearch)
+{
+    auto mesh = gridMesh(20, 5);
+    for(const bool merged : {false, true}) {
+        if(merged) {
+            mesh.MergeGreedy();
+        }
+        for(double y = -1.0; y <= 6.0; y += 0.25) {
+            for(double x = -1.0; x <= 21.0; x += 0.3) {
+                EXPECT_EQ(
+                    mesh.FindContainingPolygon({x, y}), findContainingPolygonLinear(mesh, {x, y}))
+                    << "at (" << x << ", " << y << ")";
+            }
+        }
+    }
+}
+
+TEST(Mesh, PointsOutsideOfGridAreNotFound)
+{
+    const auto mesh = gridMesh(3, 3);
+    EXPECT_EQ(mesh.FindContainingPolygon({-0.1, 1}), Mesh::Polygon::InvalidIndex);
+    EXPECT_EQ(mesh.FindContainingPolygon({1, 3.1}), Mesh::Polygon::InvalidIndex);
+    EXPECT_NE(mesh.FindContainingPolygon({3, 3}), Mesh::Polygon::InvalidIndex);
+    EXPECT_NE(mesh.FindContainingPolygon({0, 0}), Mesh::Polygon::InvalidIndex);
+}
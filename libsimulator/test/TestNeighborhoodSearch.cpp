@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
 #include "GenericAgent.hpp"
 #include "NeighborhoodSearch.hpp"
 
@@ -8,6 +9,9 @@
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <random>
+#include <set>
+#include <vector>
 
 template <typename T>
 struct ValueWithPos {
@@ -126,3 +130,199 @@ TEST(NeighborhoodSearch, ReturnsValueExactlyDistanceAwayFromQueryPoint)
         [](const auto& v) { return v.val; });
     ASSERT_EQ(actual, expected);
 }
+
+TEST(NeighborhoodSearch, ForEachNeighborVisitsStoredValuesInPlace)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{3};
+    const AgentContainer<ValueWithPos<int>> agents{
+        {{0, 0}, 1}, {{-3, 0}, 0}, {{4, 4}, 6}, {{10, 10}, 7}};
+    neighborhood.Update(agents);
+
+    std::vector<const ValueWithPos<int>*> visited{};
+    neighborhood.ForEachNeighbor(
+        {0, 0}, 10, [&visited](const auto& value) { visited.push_back(&value); });
+    // The values are visited where they are stored, not as copies
+    const std::set<const ValueWithPos<int>*> expected{&agents[0], &agents[1], &agents[2]};
+    ASSERT_EQ(visited.size(), expected.size());
+    ASSERT_EQ(std::set(std::begin(visited), std::end(visited)), expected);
+}
+
+TEST(NeighborhoodSearch, PointerQueryMatchesCopyingQuery)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{3};
+    const AgentContainer<ValueWithPos<int>> agents{
+        {{0, 0}, 1}, {{-3, 0}, 0}, {{4, 4}, 6}, {{10, 10}, 7}, {{0.4, 0.4}, 3}};
+    neighborhood.Update(agents);
+
+    std::vector<const ValueWithPos<int>*> pointers{nullptr};
+    neighborhood.GetNeighboringAgents({0, 0}, 10, pointers);
+    const auto copies = neighborhood.GetNeighboringAgents({0, 0}, 10);
+    ASSERT_EQ(pointers.size(), copies.size());
+    for(size_t index = 0; index < copies.size(); ++index) {
+        ASSERT_EQ(pointers[index]->val, copies[index].val);
+    }
+}
+
+TEST(NeighborhoodSearch, ReturnsValuesOutsideOfBounds)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{1, AABB{{0, 0}, {10, 10}}};
+    const AgentContainer<ValueWithPos<int>> agents{
+        {{5, 5}, 1}, {{-20, 5}, 2}, {{30, 30}, 3}, {{11, -1}, 4}};
+    neighborhood.Update(agents);
+
+    const auto collect = [&neighborhood](Point pos, double radius) {
+        std::set<int> values{};
+        neighborhood.ForEachNeighbor(
+            pos, radius, [&values](const auto& value) { values.insert(value.val); });
+        return values;
+    };
+    ASSERT_EQ(collect({-20, 5}, 0.5), std::set<int>{2});
+    ASSERT_EQ(collect({29, 29}, 2), std::set<int>{3});
+    ASSERT_EQ(collect({10, 0}, 1.5), std::set<int>{4});
+    ASSERT_EQ(collect({5, 5}, 100), (std::set<int>{1, 2, 3, 4}));
+    ASSERT_EQ(collect({5, 5}, 1), std::set<int>{1});
+}
+
+TEST(NeighborhoodSearch, FindsValuesAddedAfterUpdate)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{1, AABB{{0, 0}, {10, 10}}};
+    AgentContainer<ValueWithPos<int>> agents{{{5, 5}, 1}};
+    neighborhood.Update(agents);
+    agents.push_back({{5.5, 5}, 2});
+    neighborhood.AddAgent(agents.back());
+
+    std::set<int> values{};
+    neighborhood.ForEachNeighbor(
+        {5, 5}, 1, [&values](const auto& value) { values.insert(value.val); });
+    ASSERT_EQ(values, (std::set<int>{1, 2}));
+}
+
+TEST(NeighborhoodSearch, UpdatePositionsMatchesFullUpdate)
+{
+    const AABB bounds{{0, 0}, {20, 10}};
+    AgentContainer<ValueWithPos<int>> agents{};
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> x(-2, 22);
+    std::uniform_real_distribution<double> y(-2, 12);
+    std::uniform_real_distribution<double> step(-1.5, 1.5);
+    std::uniform_real_distribution<double> smallStep(-0.3, 0.3);
+    for(int index = 0; index < 200; ++index) {
+        agents.push_back({{x(gen), y(gen)}, index});
+    }
+    NeighborhoodSearch<ValueWithPos<int>> incremental{1, bounds};
+    incremental.Update(agents);
+
+    // Neighbors are compared in visiting order, which determines how forces are summed up
+    const auto collect = [](const auto& neighborhood, Point pos, double radius) {
+        std::vector<int> values{};
+        neighborhood.ForEachNeighbor(
+            pos, radius, [&values](const auto& value) { values.push_back(value.val); });
+        return values;
+    };
+
+    for(int iteration = 0; iteration < 20; ++iteration) {
+        // Move a copy of the agents, as the operational step swaps in a new generation
+        auto next = agents;
+        for(auto& agent : next) {
+            if(iteration % 5 == 0) {
+                agent.pos += Point{step(gen), step(gen)};
+            } else if(agent.val % 4 == 0) {
+                agent.pos += Point{smallStep(gen), smallStep(gen)};
+            }
+        }
+        agents.swap(next);
+        incremental.UpdatePositions(agents);
+
+        NeighborhoodSearch<ValueWithPos<int>> reference{1, bounds};
+        reference.Update(agents);
+        for(int query = 0; query < 20; ++query) {
+            const Point pos{x(gen), y(gen)};
+            ASSERT_EQ(collect(incremental, pos, 2.5), collect(reference, pos, 2.5));
+        }
+    }
+}
+
+TEST(NeighborhoodSearch, UpdatePositionsRebuildsAfterAddAgent)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{1, AABB{{0, 0}, {10, 10}}};
+    AgentContainer<ValueWithPos<int>> agents{{{5, 5}, 1}};
+    neighborhood.Update(agents);
+    agents.push_back({{8, 8}, 2});
+    neighborhood.AddAgent(agents.back());
+    agents.back().pos = {2, 2};
+    neighborhood.UpdatePositions(agents);
+
+    std::set<int> values{};
+    neighborhood.ForEachNeighbor(
+        {2, 2}, 0.5, [&values](const auto& value) { values.insert(value.val); });
+    ASSERT_EQ(values, std::set<int>{2});
+}
+
+TEST(NeighborhoodSearch, NeighborListsMatchGridQueries)
+{
+    const AABB bounds{{0, 0}, {20, 10}};
+    AgentContainer<ValueWithPos<int>> agents{};
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> x(0, 20);
+    std::uniform_real_distribution<double> y(0, 10);
+    std::uniform_real_distribution<double> step(-0.05, 0.05);
+    for(int index = 0; index < 200; ++index) {
+        agents.push_back({{x(gen), y(gen)}, index});
+    }
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{1, bounds};
+    neighborhood.EnableNeighborLists(2, 0.4);
+    neighborhood.Update(agents);
+    ASSERT_TRUE(neighborhood.NeighborListsOutdated());
+
+    const auto collect = [](const auto& neighborhood, const auto& agent, double radius) {
+        std::set<int> values{};
+        neighborhood.ForEachNeighborOf(
+            agent, radius, [&values](const auto& value) { values.insert(value.val); });
+        return values;
+    };
+
+    int rebuilds = 0;
+    for(int iteration = 0; iteration < 40; ++iteration) {
+        if(neighborhood.NeighborListsOutdated()) {
+            neighborhood.RebuildNeighborLists();
+            ++rebuilds;
+        }
+        ASSERT_FALSE(neighborhood.NeighborListsOutdated());
+
+        NeighborhoodSearch<ValueWithPos<int>> reference{1, bounds};
+        reference.Update(agents);
+        for(const auto& agent : agents) {
+            ASSERT_EQ(collect(neighborhood, agent, 2), collect(reference, agent, 2));
+            // Larger than the cut off radius of the lists, served by the grid
+            ASSERT_EQ(collect(neighborhood, agent, 3), collect(reference, agent, 3));
+        }
+
+        auto next = agents;
+        for(auto& agent : next) {
+            agent.pos += Point{step(gen), step(gen)};
+        }
+        agents.swap(next);
+        neighborhood.UpdatePositions(agents);
+    }
+    ASSERT_GT(rebuilds, 1);
+    ASSERT_LT(rebuilds, 40);
+}
+
+TEST(NeighborhoodSearch, NeighborListsAreOutdatedAfterAddAgent)
+{
+    NeighborhoodSearch<ValueWithPos<int>> neighborhood{1, AABB{{0, 0}, {10, 10}}};
+    AgentContainer<ValueWithPos<int>> agents{{{5, 5}, 1}};
+    neighborhood.EnableNeighborLists(2, 0.4);
+    neighborhood.Update(agents);
+    neighborhood.RebuildNeighborLists();
+    ASSERT_FALSE(neighborhood.NeighborListsOutdated());
+
+    agents.push_back({{5.5, 5}, 2});
+    neighborhood.AddAgent(agents.back());
+    ASSERT_TRUE(neighborhood.NeighborListsOutdated());
+
+    std::set<int> values{};
+    neighborhood.ForEachNeighborOf(
+        agents.front(), 2, [&values](const auto& value) { values.insert(value.val); });
+    ASSERT_EQ(values, (std::set<int>{1, 2}));
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "Polyanya.hpp"
+
+#include "Mesh.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+
+#include <glm/ext/vector_double2.hpp>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+constexpr size_t X = Mesh::Polygon::InvalidIndex;
+
+double lengthOf(const std::vector<Point>& path)
+{
+    double length{};
+    for(size_t index = 1; index < path.size(); ++index) {
+        length += Distance(path[index - 1], path[index]);
+    }
+    return length;
+}
+
+// Corridor turning left twice, made of a bottom, a right and a top polygon
+Mesh uShape()
+{
+    return Mesh(
+        {{0, 0}, {10, 0}, {10, 2}, {8, 2}, {0, 2}, {10, 8}, {8, 8}, {0, 8}, {10, 10}, {0, 10}},
+        {{{0, 1, 2, 3, 4}, {X, X, 1, X, X}},
+         {{3, 2, 5, 6}, {0, X, 2, X}},
+         {{7, 6, 5, 8, 9}, {X, 1, X, X, X}}});
+}
+
+// Square with a square hole in the middle, made of four trapezoids
+Mesh squareWithHole()
+{
+    return Mesh(
+        {{0, 0}, {10, 0}, {10, 10}, {0, 10}, {4, 4}, {6, 4}, {6, 6}, {4, 6}},
+        {{{0, 1, 5, 4}, {X, 1, X, 3}},
+         {{1, 2, 6, 5}, {X, 2, X, 0}},
+         {{2, 3, 7, 6}, {X, 3, X, 1}},
+         {{3, 0, 4, 7}, {X, 0, X, 2}}});
+}
+} // namespace
+
+TEST(Polyanya, SamePolygonIsStraightLine)
+{
+    Polyanya polyanya(uShape());
+    const auto path = polyanya.ComputeAllWaypoints({1, 1}, {9, 1});
+    EXPECT_EQ(path, (std::vector<Point>{{1, 1}, {9, 1}}));
+    EXPECT_EQ(polyanya.LastSearchExpansions(), 0);
+}
+
+TEST(Polyanya, VisibleDestinationInOtherPolygonIsStraightLine)
+{
+    Polyanya polyanya(squareWithHole());
+    const auto path = polyanya.ComputeAllWaypoints({1, 1}, {9, 2});
+    EXPECT_EQ(path, (std::vector<Point>{{1, 1}, {9, 2}}));
+}
+
+TEST(Polyanya, PathTurnsAtCorners)
+{
+    Polyanya polyanya(uShape());
+    const auto path = polyanya.ComputeAllWaypoints({1, 1}, {1, 9});
+    EXPECT_EQ(path, (std::vector<Point>{{1, 1}, {8, 2}, {8, 8}, {1, 9}}));
+}
+
+TEST(Polyanya, PathAroundHoleIsShortest)
+{
+    Polyanya polyanya(squareWithHole());
+    const auto path = polyanya.ComputeAllWaypoints({5, 1}, {5, 9});
+    ASSERT_EQ(path.size(), 4);
+    EXPECT_EQ(path.front(), Point(5, 1));
+    EXPECT_EQ(path.back(), Point(5, 9));
+    EXPECT_NEAR(lengthOf(path), 2 * std::sqrt(10.0) + 2, 1e-9);
+    EXPECT_EQ(path[1].y, 4);
+    EXPECT_EQ(path[2].y, 6);
+    EXPECT_EQ(path[1].x, path[2].x);
+}
+
+TEST(Polyanya, PathsAreSymmetric)
+{
+    Polyanya polyanya(squareWithHole());
+    const auto there = polyanya.ComputeAllWaypoints({1, 5}, {9, 6});
+    const auto back = polyanya.ComputeAllWaypoints({9, 6}, {1, 5});
+    EXPECT_NEAR(lengthOf(there), lengthOf(back), 1e-9);
+    EXPECT_GT(polyanya.LastSearchExpansions(), 0);
+}
+
+TEST(Polyanya, PointsOutsideThrow)
+{
+    Polyanya polyanya(squareWithHole());
+    EXPECT_THROW(polyanya.ComputeAllWaypoints({5, 5}, {1, 1}), SimulationError);
+    EXPECT_THROW(polyanya.ComputeAllWaypoints({1, 1}, {11, 1}), SimulationError);
+}
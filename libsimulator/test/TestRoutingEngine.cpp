@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "RoutingEngine.hpp"
+
+#include "CfgCgal.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+PolyWithHoles polygonOf(const std::vector<K::Point_2>& boundary)
+{
+    return PolyWithHoles(Poly(std::begin(boundary), std::end(boundary)));
+}
+
+// Corridor turning left twice, paths from the bottom to the top need two corners
+PolyWithHoles uShape()
+{
+    return polygonOf({{0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 8}, {8, 8}, {8, 2}, {0, 2}});
+}
+
+// Square room with a pillar in the middle, which can be passed on both sides
+PolyWithHoles roomWithPillar()
+{
+    const std::vector<K::Point_2> boundary{{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+    const std::vector<K::Point_2> pillar{{4, 4}, {4, 6}, {6, 6}, {6, 4}};
+    const std::vector<Poly> holes{Poly(std::begin(pillar), std::end(pillar))};
+    return PolyWithHoles(
+        Poly(std::begin(boundary), std::end(boundary)), std::begin(holes), std::end(holes));
+}
+} // namespace
+
+TEST(RoutingEngine, WaypointInSameTriangleIsDestination)
+{
+    RoutingEngine engine(polygonOf({{0, 0}, {10, 0}, {10, 10}, {0, 10}}));
+    EXPECT_EQ(engine.ComputeWaypoint({2, 1}, {3, 1}), Point(3, 1));
+}
+
+TEST(RoutingEngine, WaypointMatchesFirstWaypointOfPath)
+{
+    RoutingEngine engine(uShape());
+    const Point destination{1, 9};
+    for(const auto& position :
+        std::vector<Point>{{1, 1}, {5, 1}, {9, 1}, {9, 5}, {9, 9}, {5, 9}, {0.5, 0.5}}) {
+        const auto path = engine.ComputeAllWaypoints(position, destination);
+        ASSERT_GE(path.size(), 2);
+        EXPECT_EQ(engine.ComputeWaypoint(position, destination), path[1])
+            << "from (" << position.x << ", " << position.y << ")";
+    }
+}
+
+TEST(RoutingEngine, TreesAreCachedPerDestination)
+{
+    RoutingEngine engine(uShape());
+    EXPECT_EQ(engine.CachedDestinationCount(), 0);
+    engine.ComputeWaypoint({1, 1}, {1, 9});
+    engine.ComputeWaypoint({5, 1}, {1, 9});
+    EXPECT_EQ(engine.CachedDestinationCount(), 1);
+    engine.ComputeWaypoint({1, 1}, {5, 9});
+    EXPECT_EQ(engine.CachedDestinationCount(), 2);
+    engine.Update();
+    EXPECT_EQ(engine.CachedDestinationCount(), 0);
+}
+
+TEST(RoutingEngine, RoutesDoNotDependOnEarlierRequests)
+{
+    const Point destination{5, 9};
+    // Ordered by distance to the destination, every request grows the tree further
+    const std::vector<Point> starts{{4, 9}, {1, 9}, {9, 5}, {1, 1}, {4.5, 1}, {5, 1}, {5.5, 1}};
+    RoutingEngine shared(roomWithPillar());
+    for(const auto& start : starts) {
+        RoutingEngine fresh(roomWithPillar());
+        const auto expected = fresh.ComputeRoute(start, destination);
+        const auto route = shared.ComputeRoute(start, destination);
+        EXPECT_EQ(route.corridor, expected.corridor) << "from " << start.x << ", " << start.y;
+        EXPECT_EQ(route.waypoints, expected.waypoints);
+        EXPECT_EQ(shared.ComputeWaypoint(start, destination), expected.waypoints.front());
+    }
+    EXPECT_EQ(shared.CachedDestinationCount(), 1);
+}
+
+TEST(RoutingEngine, DestinationOutsideThrows)
+{
+    RoutingEngine engine(uShape());
+    EXPECT_THROW(engine.ComputeWaypoint({1, 1}, {5, 5}), SimulationError);
+    EXPECT_EQ(engine.CachedDestinationCount(), 0);
+}
+
+TEST(RoutingEngine, RouteEndsAtDestination)
+{
+    RoutingEngine engine(uShape());
+    const Point start{1, 1};
+    const Point destination{1, 9};
+    const auto route = engine.ComputeRoute(start, destination);
+    ASSERT_FALSE(route.corridor.empty());
+    ASSERT_FALSE(route.waypoints.empty());
+    EXPECT_EQ(route.waypoints.back(), destination);
+    EXPECT_EQ(route.passedAt.size(), route.waypoints.size());
+    EXPECT_EQ(route.passedAt.back(), route.corridor.size());
+    EXPECT_TRUE(engine.FaceContains(route.corridor.front(), start));
+    EXPECT_TRUE(engine.FaceContains(route.corridor.back(), destination));
+    EXPECT_TRUE(std::is_sorted(std::begin(route.passedAt), std::end(route.passedAt)));
+}
+
+TEST(RoutingEngine, RouteWaypointsMatchPath)
+{
+    RoutingEngine engine(uShape());
+    const auto route = engine.ComputeRoute({1, 1}, {1, 9});
+    const auto path = engine.ComputeAllWaypoints({1, 1}, {1, 9});
+    ASSERT_EQ(route.waypoints.size() + 1, path.size());
+    EXPECT_TRUE(std::equal(
+        std::begin(route.waypoints), std::end(route.waypoints), std::next(path.begin())));
+}
+
+TEST(RoutingEngine, RepeatedSearchesReuseState)
+{
+    RoutingEngine engine(uShape());
+    const auto first = engine.ComputeAllWaypoints({1, 1}, {1, 9});
+    const auto expansions = engine.LastSearchExpansions();
+    EXPECT_GT(expansions, 0);
+    engine.ComputeAllWaypoints({9, 9}, {9, 1});
+    EXPECT_EQ(engine.ComputeAllWaypoints({1, 1}, {1, 9}), first);
+    EXPECT_EQ(engine.LastSearchExpansions(), expansions);
+}
+
+TEST(RoutingEngine, RouteDoesNotDependOnFaceHint)
+{
+    RoutingEngine engine(uShape());
+    const auto route = engine.ComputeRoute({1, 1}, {1, 9});
+    const auto farFace = engine.ComputeRoute({9, 9}, {1, 9}).corridor.front();
+    for(const auto hint : {RoutingEngine::NoFaceHint, route.corridor.front(), farFace}) {
+        const auto hinted = engine.ComputeRoute({1, 1}, {1, 9}, hint);
+        EXPECT_EQ(hinted.corridor, route.corridor);
+        EXPECT_EQ(hinted.waypoints, route.waypoints);
+    }
+}
+
+TEST(RoutingEngine, PolyanyaTurnsAtCorners)
+{
+    RoutingEngine engine(uShape());
+    engine.SetAlgorithm(RoutingAlgorithm::Polyanya);
+    EXPECT_EQ(
+        engine.ComputeAllWaypoints({1, 1}, {1, 9}),
+        (std::vector<Point>{{1, 1}, {8, 2}, {8, 8}, {1, 9}}));
+    EXPECT_GT(engine.LastSearchExpansions(), 0);
+    EXPECT_THROW(engine.ComputeAllWaypoints({1, 1}, {1, 5}), SimulationError);
+}
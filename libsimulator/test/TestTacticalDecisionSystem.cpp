@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "TacticalDecisionSystem.hpp"
+
+#include "CfgCgal.hpp"
+#include "CollisionFreeSpeedModel.hpp"
+#include "GenericAgent.hpp"
+#include "Point.hpp"
+#include "RoutingEngine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace
+{
+// Corridor turning left twice, paths from the bottom to the top need two corners
+PolyWithHoles uShape()
+{
+    const std::vector<K::Point_2> boundary{
+        {0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 8}, {8, 8}, {8, 2}, {0, 2}};
+    return PolyWithHoles(Poly(std::begin(boundary), std::end(boundary)));
+}
+
+AgentContainer<GenericAgent> agentAt(Point position, Point destination)
+{
+    AgentContainer<GenericAgent> agents{};
+    auto& agent = agents.emplace_back(
+        GenericAgent::ID::Invalid,
+        jps::UniqueID<Journey>::Invalid,
+        jps::UniqueID<BaseStage>::Invalid,
+        CollisionFreeSpeedModel::State{position});
+    agent.finalTarget = destination;
+    return agents;
+}
+
+// First point of a 0.25 m raster over the u-shape accepted by 'predicate'
+template <typename Predicate>
+std::optional<Point> findPoint(Predicate&& predicate)
+{
+    for(double x = 0.125; x < 10; x += 0.25) {
+        for(double y = 0.125; y < 10; y += 0.25) {
+            if(predicate(Point{x, y})) {
+                return Point{x, y};
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+bool inAnyFace(const RoutingEngine& engine, const std::vector<size_t>& faces, Point p)
+{
+    return std::any_of(std::begin(faces), std::end(faces), [&engine, p](auto face) {
+        return engine.FaceContains(face, p);
+    });
+}
+
+std::optional<Point>
+pointInFace(const RoutingEngine& engine, size_t face, const std::vector<size_t>& excluded = {})
+{
+    return findPoint([&](Point p) {
+        return engine.FaceContains(face, p) && !inAnyFace(engine, excluded, p);
+    });
+}
+} // namespace
+
+TEST(TacticalDecisionSystem, HeadsToFirstCorner)
+{
+    RoutingEngine engine(uShape());
+    TacticalDecisionSystem system{};
+    auto agents = agentAt({1, 1}, {1, 9});
+    const auto route = engine.ComputeRoute({1, 1}, {1, 9});
+
+    EXPECT_EQ(system.Run(engine, agents), 1);
+    EXPECT_EQ(agents.front().nextTarget, route.waypoints.front());
+    EXPECT_EQ(system.Run(engine, agents), 0);
+    EXPECT_EQ(agents.front().nextTarget, route.waypoints.front());
+}
+
+TEST(TacticalDecisionSystem, PassingCornerAdvancesToNextWaypoint)
+{
+    RoutingEngine engine(uShape());
+    TacticalDecisionSystem system{};
+    auto agents = agentAt({1, 1}, {1, 9});
+    const auto route = engine.ComputeRoute({1, 1}, {1, 9});
+    ASSERT_GE(route.waypoints.size(), 2);
+    system.Run(engine, agents);
+
+    const auto passed = pointInFace(engine, route.corridor[route.passedAt[0]]);
+    ASSERT_TRUE(passed);
+    agents.front().position() = *passed;
+    EXPECT_EQ(system.Run(engine, agents), 0);
+    EXPECT_EQ(agents.front().nextTarget, route.waypoints[1]);
+}
+
+TEST(TacticalDecisionSystem, SteppingBackHeadsToCornerAgain)
+{
+    RoutingEngine engine(uShape());
+    TacticalDecisionSystem system{};
+    auto agents = agentAt({1, 1}, {1, 9});
+    const auto route = engine.ComputeRoute({1, 1}, {1, 9});
+    ASSERT_GE(route.waypoints.size(), 2);
+    const auto firstPassed = route.passedAt[0];
+    ASSERT_GT(firstPassed, 0);
+    system.Run(engine, agents);
+
+    const auto passed = pointInFace(engine, route.corridor[firstPassed]);
+    ASSERT_TRUE(passed);
+    agents.front().position() = *passed;
+    system.Run(engine, agents);
+    ASSERT_EQ(agents.front().nextTarget, route.waypoints[1]);
+
+    const auto behind =
+        pointInFace(engine, route.corridor[firstPassed - 1], {route.corridor[firstPassed]});
+    ASSERT_TRUE(behind);
+    agents.front().position() = *behind;
+    EXPECT_EQ(system.Run(engine, agents), 0);
+    EXPECT_EQ(agents.front().nextTarget, route.waypoints[0]);
+}
+
+TEST(TacticalDecisionSystem, LeavingCorridorReplans)
+{
+    RoutingEngine engine(uShape());
+    TacticalDecisionSystem system{};
+    auto agents = agentAt({9, 3}, {9, 7});
+    const auto route = engine.ComputeRoute({9, 3}, {9, 7});
+    system.Run(engine, agents);
+
+    const auto outside = findPoint([&engine, &route](Point p) {
+        return engine.IsRoutable(p) && !inAnyFace(engine, route.corridor, p);
+    });
+    ASSERT_TRUE(outside);
+    agents.front().position() = *outside;
+    EXPECT_EQ(system.Run(engine, agents), 1);
+    EXPECT_EQ(
+        agents.front().nextTarget, engine.ComputeRoute(*outside, {9, 7}).waypoints.front());
+}
+
+TEST(TacticalDecisionSystem, ChangedDestinationReplans)
+{
+    RoutingEngine engine(uShape());
+    TacticalDecisionSystem system{};
+    auto agents = agentAt({1, 1}, {1, 9});
+    system.Run(engine, agents);
+
+    agents.front().finalTarget = {5, 1};
+    EXPECT_EQ(system.Run(engine, agents), 1);
+    EXPECT_EQ(agents.front().nextTarget, Point(5, 1));
+    EXPECT_EQ(system.Run(engine, agents), 0);
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(ThreadPool, ZeroThreadsIsTreatedAsOne)
+{
+    ThreadPool pool{0};
+    ASSERT_EQ(pool.ThreadCount(), 1);
+}
+
+TEST(ThreadPool, VisitsEveryIndexExactlyOnce)
+{
+    for(size_t threads : {1, 2, 3, 8}) {
+        ThreadPool pool{threads};
+        ASSERT_EQ(pool.ThreadCount(), threads);
+        for(size_t count : {0, 1, 2, 7, 1000}) {
+            std::vector<int> visits(count, 0);
+            pool.ParallelFor(count, [&visits](size_t begin, size_t end) {
+                for(size_t index = begin; index < end; ++index) {
+                    ++visits[index];
+                }
+            });
+            for(const auto v : visits) {
+                ASSERT_EQ(v, 1);
+            }
+        }
+    }
+}
+
+TEST(ThreadPool, CanBeReusedForManyLoops)
+{
+    ThreadPool pool{4};
+    std::vector<size_t> values(100, 0);
+    for(size_t round = 0; round < 500; ++round) {
+        pool.ParallelFor(values.size(), [&values](size_t begin, size_t end) {
+            for(size_t index = begin; index < end; ++index) {
+                values[index] += index;
+            }
+        });
+    }
+    for(size_t index = 0; index < values.size(); ++index) {
+        ASSERT_EQ(values[index], index * 500);
+    }
+}
+
+TEST(ThreadPool, RethrowsExceptionOfLowestFailingChunk)
+{
+    ThreadPool pool{4};
+    const auto fn = [](size_t begin, size_t end) {
+        for(size_t index = begin; index < end; ++index) {
+            if(index == 30 || index == 90) {
+                throw std::runtime_error(std::to_string(index));
+            }
+        }
+    };
+    try {
+        pool.ParallelFor(100, fn);
+        FAIL() << "Expected exception";
+    } catch(const std::runtime_error& e) {
+        ASSERT_STREQ(e.what(), "30");
+    }
+
+    // Pool stays usable after a failed loop
+    size_t visited = 0;
+    pool.ParallelFor(1, [&visited](size_t begin, size_t end) { visited += end - begin; });
+    ASSERT_EQ(visited, 1);
+}
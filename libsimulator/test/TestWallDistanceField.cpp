@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "CollisionGeometry.hpp"
+#include "Point.hpp"
+#include "SimulationError.hpp"
+#include "WallDistanceField.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+CollisionGeometry makeSquare(double side)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> points{{0., 0.}, {side, 0.}, {side, side}, {0., side}};
+    return CollisionGeometry(PolyWithHoles(Poly{points.begin(), points.end()}));
+}
+} // namespace
+
+TEST(WallDistanceField, IsOptional)
+{
+    auto geometry = makeSquare(10.);
+    ASSERT_EQ(geometry.WallDistances(), nullptr);
+    geometry.BuildWallDistanceField(0.1);
+    ASSERT_NE(geometry.WallDistances(), nullptr);
+    ASSERT_DOUBLE_EQ(geometry.WallDistances()->Resolution(), 0.1);
+    geometry.BuildWallDistanceField(0.);
+    ASSERT_EQ(geometry.WallDistances(), nullptr);
+    ASSERT_THROW(geometry.BuildWallDistanceField(-1.), SimulationError);
+}
+
+TEST(WallDistanceField, MatchesDistanceToClosestWall)
+{
+    const auto geometry = makeSquare(10.);
+    const WallDistanceField field(geometry, 0.1, 4.);
+
+    for(double x = 0.05; x < 10.; x += 0.37) {
+        for(double y = 0.05; y < 10.; y += 0.37) {
+            const auto expected = std::min({x, y, 10. - x, 10. - y, 4.});
+            const auto sample = field.SampleAt({x, y});
+            ASSERT_NEAR(sample.distance, expected, 0.1) << x << ", " << y;
+        }
+    }
+}
+
+TEST(WallDistanceField, GradientPointsAwayFromClosestWall)
+{
+    const auto geometry = makeSquare(10.);
+    const WallDistanceField field(geometry, 0.1, 4.);
+
+    const auto left = field.SampleAt({0.53, 5.});
+    ASSERT_NEAR(left.distance, 0.53, 1e-9);
+    ASSERT_NEAR(left.gradient.x, 1., 1e-9);
+    ASSERT_NEAR(left.gradient.y, 0., 1e-9);
+
+    const auto top = field.SampleAt({5., 9.71});
+    ASSERT_NEAR(top.distance, 0.29, 1e-9);
+    ASSERT_NEAR(top.gradient.x, 0., 1e-9);
+    ASSERT_NEAR(top.gradient.y, -1., 1e-9);
+
+    const auto center = field.SampleAt({5., 5.});
+    ASSERT_DOUBLE_EQ(center.distance, 4.);
+    ASSERT_EQ(center.gradient, Point(0., 0.));
+}
+
+TEST(WallDistanceField, IsNegativeOutside)
+{
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> exterior{{0., 0.}, {10., 0.}, {10., 10.}, {0., 10.}};
+    const std::vector<CGALPoint> hole{{4., 4.}, {6., 4.}, {6., 6.}, {4., 6.}};
+    const std::vector<Poly> holes{Poly{hole.begin(), hole.end()}};
+    const CollisionGeometry geometry(
+        PolyWithHoles(Poly{exterior.begin(), exterior.end()}, holes.begin(), holes.end()));
+    const WallDistanceField field(geometry, 0.1, 4.);
+
+    const auto sample = field.SampleAt({5., 4.5});
+    ASSERT_NEAR(sample.distance, -0.5, 1e-9);
+    ASSERT_NEAR(sample.gradient.x, 0., 1e-9);
+    ASSERT_NEAR(sample.gradient.y, -1., 1e-9);
+}
@@ -7,6 +7,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h> // IWYU pragma: keep
 
+#include <iterator>
+#include <memory>
 #include <tuple>
 #include <vector>
 
@@ -14,7 +16,7 @@ namespace py = pybind11;
 
 void init_geometry(py::module_& m)
 {
-    py::class_<CollisionGeometry>(m, "Geometry")
+    py::class_<CollisionGeometry, std::shared_ptr<CollisionGeometry>>(m, "Geometry")
         .def(
             "boundary",
             [](const CollisionGeometry& geo) {
@@ -23,7 +25,7 @@ void init_geometry(py::module_& m)
         .def(
             "holes",
             [](const CollisionGeometry& geo) {
-                const auto holes = std::get<1>(geo.AccessibleArea());
+                const auto& holes = std::get<1>(geo.AccessibleArea());
                 std::vector<std::vector<std::tuple<double, double>>> res{};
                 res.reserve(holes.size());
                 for(const auto& hole : holes) {
@@ -31,11 +33,19 @@ void init_geometry(py::module_& m)
                 }
                 return res;
             })
-        .def("linesegments_close_to", &CollisionGeometry::LineSegmentsInApproxDistanceTo)
+        .def(
+            "linesegments_close_to",
+            [](const CollisionGeometry& geo, Point p) {
+                const auto segments = geo.LineSegmentsInApproxDistanceTo(p);
+                return std::vector<LineSegment>(std::begin(segments), std::end(segments));
+            })
+        .def("grid_cell_size", &CollisionGeometry::CellSize)
+        .def("hash", &CollisionGeometry::Hash)
+        .def("as_wkt", &CollisionGeometry::Wkt)
         .def(
             "linesegments_in_distance_to",
             [](const CollisionGeometry& geo, double distance, std::tuple<double, double> pos) {
-                return intoVec(geo.LineSegmentsInDistanceTo(distance, intoPoint(pos)));
+                return geo.LineSegmentsInDistanceTo(distance, intoPoint(pos));
             });
     py::class_<GeometryBuilder>(m, "GeometryBuilder")
         .def(py::init<>())
@@ -49,5 +59,8 @@ void init_geometry(py::module_& m)
             [](GeometryBuilder& builder, const std::vector<std::tuple<double, double>>& points) {
                 builder.ExcludeFromAccessibleArea(intoPoints(points));
             })
+        .def(
+            "set_grid_cell_size",
+            [](GeometryBuilder& builder, double cellSize) { builder.SetGridCellSize(cellSize); })
         .def("build", &GeometryBuilder::Build);
 }
@@ -17,10 +17,19 @@ namespace py = pybind11;
 
 void init_routing(py::module_& m)
 {
+    py::enum_<RoutingAlgorithm>(m, "RoutingAlgorithm")
+        .value("TriangleAStar", RoutingAlgorithm::TriangleAStar)
+        .value("Polyanya", RoutingAlgorithm::Polyanya);
+
     py::class_<RoutingEngine>(m, "RoutingEngine")
-        .def(py::init([](const CollisionGeometry& geo) {
-            return std::make_unique<RoutingEngine>(geo.Polygon());
-        }))
+        .def(
+            py::init([](const CollisionGeometry& geo, RoutingAlgorithm algorithm) {
+                auto engine = std::make_unique<RoutingEngine>(geo.Polygon());
+                engine->SetAlgorithm(algorithm);
+                return engine;
+            }),
+            py::arg("geometry"),
+            py::arg("algorithm") = RoutingAlgorithm::TriangleAStar)
         .def(
             "compute_waypoints",
             [](RoutingEngine& engine,
@@ -28,6 +37,7 @@ void init_routing(py::module_& m)
                std::tuple<double, double> to) {
                 return intoTuples(engine.ComputeAllWaypoints(intoPoint(from), intoPoint(to)));
             })
+        .def("last_search_expansions", &RoutingEngine::LastSearchExpansions)
         .def(
             "is_routable",
             [](RoutingEngine& engine, std::tuple<double, double> point) {
@@ -18,9 +18,11 @@
 #include <pybind11/stl.h> // IWYU pragma: keep
 
 #include <cstdint>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -33,18 +35,24 @@ void init_simulation(py::module_& m)
             // The model is moved out of the Python object into Simulation. After this constructor
             // returns, the Python model object passed here is disowned/invalid and must not be
             // reused.
-            py::init(
-                [](std::unique_ptr<OperationalModel> model, CollisionGeometry geometry, double dT) {
-                    if(!model) {
-                        throw std::invalid_argument("model must not be None");
-                    }
-                    return std::make_unique<Simulation>(
-                        std::move(model), std::make_unique<CollisionGeometry>(geometry), dT);
-                }),
+            py::init([](std::unique_ptr<OperationalModel> model,
+                        std::shared_ptr<CollisionGeometry> geometry,
+                        double dT,
+                        const std::string& geometryCacheDir) {
+                if(!model) {
+                    throw std::invalid_argument("model must not be None");
+                }
+                return std::make_unique<Simulation>(
+                    std::move(model),
+                    std::move(geometry),
+                    dT,
+                    std::filesystem::path(geometryCacheDir));
+            }),
             py::kw_only(),
             py::arg("model"),
             py::arg("geometry"),
-            py::arg("dt"))
+            py::arg("dt"),
+            py::arg("geometry_cache_dir") = "")
         .def(
             "add_waypoint_stage",
             [](Simulation& sim, std::tuple<double, double> position, double distance) {
@@ -107,7 +115,11 @@ void init_simulation(py::module_& m)
                 }
                 return agent_ids;
             })
-        .def("iterate", [](Simulation& sim) { sim.Iterate(); })
+        // Worker threads of the operational step acquire the GIL to call Python log callbacks
+        .def(
+            "iterate",
+            [](Simulation& sim) { sim.Iterate(); },
+            py::call_guard<py::gil_scoped_release>())
         .def(
             "switch_agent_journey",
             [](Simulation& sim, uint64_t agentId, uint64_t journeyId, uint64_t stageId) {
@@ -158,10 +170,36 @@ void init_simulation(py::module_& m)
             })
         .def("get_stage_proxy", [](Simulation& sim, uint64_t id) { return sim.Stage(id); })
         .def("set_tracing", [](Simulation& sim, bool status) { sim.SetTracing(status); })
+        .def(
+            "set_thread_count",
+            [](Simulation& sim, size_t threadCount) { sim.SetThreadCount(threadCount); })
+        .def("thread_count", [](const Simulation& sim) { return sim.ThreadCount(); })
+        .def(
+            "set_neighbor_list_skin",
+            [](Simulation& sim, double skin) { sim.SetNeighborListSkin(skin); })
+        .def("neighbor_list_skin", [](const Simulation& sim) { return sim.NeighborListSkin(); })
+        .def(
+            "neighbor_list_rebuild_count",
+            [](const Simulation& sim) { return sim.NeighborListRebuildCount(); })
+        .def(
+            "route_replan_count", [](const Simulation& sim) { return sim.RouteReplanCount(); })
+        .def(
+            "set_wall_distance_field_resolution",
+            [](Simulation& sim, double resolution) {
+                sim.SetWallDistanceFieldResolution(resolution);
+            })
+        .def(
+            "wall_distance_field_resolution",
+            [](const Simulation& sim) { return sim.WallDistanceFieldResolution(); })
         .def(
             "set_timer_log_level",
             [](Simulation& sim, size_t level) { sim.SetTimerLogLevel(level); })
-        .def("get_geometry", [](Simulation& sim) { return sim.Geo(); })
+        .def(
+            "get_geometry",
+            [](Simulation& sim) {
+                // pybind11 has no const holders, the Python type only exposes const methods
+                return std::const_pointer_cast<CollisionGeometry>(sim.Geo());
+            })
         .def(
             "push_timer",
             [](Simulation& sim, const std::string& name, size_t probe_log_level) {
@@ -171,5 +209,8 @@ void init_simulation(py::module_& m)
         .def(
             "get_duration",
             [](Simulation& sim, const std::string_view name) { return sim.GetTimerDuration(name); })
-        .def("get_durations", [](Simulation& sim) { return sim.GetTimerDurations(); });
+        .def("get_durations", [](Simulation& sim) { return sim.GetTimerDurations(); })
+        .def(
+            "get_count",
+            [](Simulation& sim, const std::string_view name) { return sim.GetTimerCount(name); });
 }
@@ -68,7 +68,7 @@ from jupedsim.models.warp_driver import (
 )
 from jupedsim.neighborhood import NeighborhoodSearch
 from jupedsim.recording import Recording, RecordingAgent, RecordingFrame
-from jupedsim.routing import RoutingEngine
+from jupedsim.routing import RoutingAlgorithm, RoutingEngine
 from jupedsim.serialization import TrajectoryWriter
 from jupedsim.simulation import Simulation
 from jupedsim.sqlite_serialization import SqliteTrajectoryWriter
@@ -137,6 +137,7 @@ __all__ = [
     "Recording",
     "RecordingAgent",
     "RecordingFrame",
+    "RoutingAlgorithm",
     "RoutingEngine",
     "Simulation",
     "SimulationError",
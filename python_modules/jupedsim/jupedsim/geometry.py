@@ -1,7 +1,5 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 
-import shapely
-
 import jupedsim.native as py_jps
 from jupedsim.linesegment import LineSegment
 
@@ -36,16 +34,26 @@ class Geometry:
         return self._obj.holes()
 
     def as_wkt(self) -> str:
-        """_summary_
+        """Access the walkable area as Well Known Text.
+
+        The text is created once when the geometry is built, calling this
+        method does not serialize the geometry again.
+
+        Returns:
+            WKT POLYGON describing the walkable area.
+        """
+        return self._obj.as_wkt()
+
+    def hash(self) -> int:
+        """Stable hash of the walkable area.
+
+        Equal hashes identify equal walkable areas, also across processes.
+        Comparing hashes is the cheapest way to detect a changed geometry.
 
         Returns:
-            String: _description_
+            Unsigned 64 bit hash.
         """
-        poly = shapely.Polygon(self.boundary(), holes=self.holes())
-        return shapely.to_wkt(
-            poly,
-            rounding_precision=-1,
-        )
+        return self._obj.hash()
 
     def linesegments_close_to(
         self, point: tuple[float, float]
@@ -19,7 +19,7 @@ class GeometryError(Exception):
         self.message = message
 
 
-def _geometry_from_wkt(wkt_input: str) -> Geometry:
+def _geometry_from_wkt(wkt_input: str, *, grid_cell_size: float) -> Geometry:
     geometry_collection = None
     try:
         wkt_type = shapely.from_wkt(wkt_input)
@@ -41,7 +41,9 @@ def _geometry_from_wkt(wkt_input: str) -> Geometry:
             ) from exc
 
     polygons = _polygons_from_geometry_collection(geometry_collection)
-    return Geometry(_internal_build_geometry(polygons))
+    return Geometry(
+        _internal_build_geometry(polygons, grid_cell_size=grid_cell_size)
+    )
 
 
 def _geometry_from_shapely(
@@ -51,18 +53,27 @@ def _geometry_from_shapely(
         | shapely.GeometryCollection
         | shapely.MultiPoint
     ),
+    *,
+    grid_cell_size: float,
 ) -> Geometry:
     polygons = _polygons_from_geometry_collection(
         shapely.GeometryCollection([geometry_input])
     )
-    return Geometry(_internal_build_geometry(polygons))
+    return Geometry(
+        _internal_build_geometry(polygons, grid_cell_size=grid_cell_size)
+    )
 
 
 def _geometry_from_coordinates(
-    coordinates: List[Tuple], *, excluded_areas: Optional[List[Tuple]] = None
+    coordinates: List[Tuple],
+    *,
+    excluded_areas: Optional[List[Tuple]] = None,
+    grid_cell_size: float,
 ) -> Geometry:
     polygon = shapely.Polygon(coordinates, holes=excluded_areas)
-    return Geometry(_internal_build_geometry([polygon]))
+    return Geometry(
+        _internal_build_geometry([polygon], grid_cell_size=grid_cell_size)
+    )
 
 
 def _polygons_from_geometry_collection(
@@ -106,9 +117,10 @@ def _polygons_from_geometry_collection(
 
 
 def _internal_build_geometry(
-    polygons: List[shapely.Polygon],
+    polygons: List[shapely.Polygon], *, grid_cell_size: float = 0.0
 ) -> py_jps.Geometry:
     geo_builder = py_jps.GeometryBuilder()
+    geo_builder.set_grid_cell_size(grid_cell_size)
 
     for polygon in polygons:
         geo_builder.add_accessible_area(polygon.exterior.coords[:-1])
@@ -153,17 +165,25 @@ def build_geometry(
         excluded_areas: describes exclusions
             from the walkable area. Only use this argument if `geometry` was
             provided as list[tuple[float, float]].
+        grid_cell_size: Edge length in meters of the cells of the grids
+            used to find walls close to agents. Smaller cells return fewer
+            walls per query for dense geometries at the expense of memory.
+            Must not be negative, 0 chooses the size from the density of the
+            geometry.
     """
+    grid_cell_size = kwargs.get("grid_cell_size", 0.0)
     if isinstance(geometry, str):
-        return _geometry_from_wkt(geometry)
+        return _geometry_from_wkt(geometry, grid_cell_size=grid_cell_size)
     elif (
         isinstance(geometry, shapely.GeometryCollection)
         or isinstance(geometry, shapely.Polygon)
         or isinstance(geometry, shapely.MultiPolygon)
         or isinstance(geometry, shapely.MultiPoint)
     ):
-        return _geometry_from_shapely(geometry)
+        return _geometry_from_shapely(geometry, grid_cell_size=grid_cell_size)
     else:
         return _geometry_from_coordinates(
-            geometry, excluded_areas=kwargs.get("excluded_areas")
+            geometry,
+            excluded_areas=kwargs.get("excluded_areas"),
+            grid_cell_size=grid_cell_size,
         )
@@ -152,6 +152,11 @@ class Hdf5TrajectoryWriter(TrajectoryWriter):
         self._frame_geometry_buffer: list[tuple[int, int]] = []
         self._last_recorded_geometry_hash: int | None = None
 
+        # Native hash, WKT and WKT hash of the geometry of the last frame
+        self._geometry_hash: int | None = None
+        self._geometry_wkt: str = ""
+        self._geometry_wkt_hash: int | None = None
+
         self._xmin = float("inf")
         self._xmax = float("-inf")
         self._ymin = float("inf")
@@ -242,10 +247,17 @@ class Hdf5TrajectoryWriter(TrajectoryWriter):
                 )
             )
 
-        wkt = simulation.get_geometry().as_wkt()
-        wkt_hash = _stable_geometry_hash(wkt)
-        self._update_bounds(wkt, wkt_hash)
-        self._record_frame_geometry(frame, wkt, wkt_hash)
+        # Only a changed geometry is fetched as WKT and hashed again
+        geometry = simulation.get_geometry()
+        if geometry.hash() != self._geometry_hash:
+            self._geometry_hash = geometry.hash()
+            self._geometry_wkt = geometry.as_wkt()
+            self._geometry_wkt_hash = _stable_geometry_hash(self._geometry_wkt)
+            self._update_bounds(self._geometry_wkt, self._geometry_wkt_hash)
+        assert self._geometry_wkt_hash is not None
+        self._record_frame_geometry(
+            frame, self._geometry_wkt, self._geometry_wkt_hash
+        )
 
         self._frames_since_flush += 1
         if self._frames_since_flush >= self._commit_every_nth_write:
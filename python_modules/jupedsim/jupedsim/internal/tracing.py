@@ -49,6 +49,13 @@ class Timer:
         """
         return self._obj.get_duration(key)
 
+    def count(self, key: str) -> int:
+        """
+        Returns:
+            How often the timer with the given name was started.
+        """
+        return self._obj.get_count(key)
+
     def push_timer(self, name: str, probe_log_level: int = 0) -> None:
         """
         Pushes a timer with the given name. The timer will be stopped when the corresponding pop_timer is called.
@@ -5,9 +5,9 @@ Based on Wolinski, Lin, and Pettré (2016) -- probabilistic collision
 avoidance using warped intrinsic fields.
 
 The model-level parameters (the precomputed intrinsic collision-probability
-field controlled by ``sigma``, the sampling and look-ahead parameters and a
-random number generator seeded by ``rng_seed``) are carried by the model
-instance, which is passed to the simulation:
+field controlled by ``sigma``, the sampling and look-ahead parameters and the
+seed ``rng_seed`` of the per-agent random number streams) are carried by the
+model instance, which is passed to the simulation:
 
 .. code:: python
 
@@ -1,5 +1,6 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 
+from enum import Enum
 from typing import Any
 
 import shapely
@@ -8,8 +9,25 @@ import jupedsim.native as py_jps
 from jupedsim.geometry_utils import build_geometry
 
 
+class RoutingAlgorithm(Enum):
+    """Search used by :meth:`RoutingEngine.compute_waypoints`."""
+
+    TRIANGLE_A_STAR = py_jps.RoutingAlgorithm.TriangleAStar
+    """A* over the triangles of the walkable area followed by a funnel."""
+    POLYANYA = py_jps.RoutingAlgorithm.Polyanya
+    """Any-angle search over the triangles merged into convex polygons.
+
+    Yields the shortest path, touching the corners of the walkable area, and
+    expands far fewer nodes on large geometries.
+    """
+
+
 class RoutingEngine:
-    """RoutingEngine to compute the shortest paths with navigation meshes."""
+    """RoutingEngine to compute the shortest paths with navigation meshes.
+
+    The search used by :meth:`compute_waypoints` is selected with `algorithm`,
+    see :class:`RoutingAlgorithm`.
+    """
 
     def __init__(
         self,
@@ -21,10 +39,11 @@ class RoutingEngine:
             | shapely.MultiPoint
             | list[tuple[float, float]]
         ),
+        algorithm: RoutingAlgorithm = RoutingAlgorithm.TRIANGLE_A_STAR,
         **kwargs: Any,
     ) -> None:
         self._obj = py_jps.RoutingEngine(
-            build_geometry(geometry, **kwargs)._obj
+            build_geometry(geometry, **kwargs)._obj, algorithm.value
         )
 
     def compute_waypoints(
@@ -61,6 +80,15 @@ class RoutingEngine:
         """
         return self._obj.compute_waypoints(frm, to)
 
+    def last_search_expansions(self) -> int:
+        """Number of nodes expanded by the last call to :meth:`compute_waypoints`.
+
+        Returns:
+            Number of triangles or Polyanya search nodes expanded.
+
+        """
+        return self._obj.last_search_expansions()
+
     def is_routable(self, p: tuple[float, float]) -> bool:
         """Tests if the supplied point is inside the underlying geometry.
 
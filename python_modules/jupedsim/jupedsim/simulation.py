@@ -1,5 +1,6 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 
+import os
 from typing import Any, Iterator
 
 import shapely
@@ -95,6 +96,11 @@ class Simulation:
         dt: float = 0.01,
         trajectory_writer: TrajectoryWriter | None = None,
         timer_log_level: int = 1,
+        num_threads: int = 1,
+        neighbor_list_skin: float = 0.0,
+        wall_distance_field_resolution: float = 0.0,
+        grid_cell_size: float = 0.0,
+        geometry_cache_dir: str | os.PathLike | None = None,
         **kwargs: Any,
     ) -> None:
         """Creates a Simulation.
@@ -134,6 +140,32 @@ class Simulation:
                 TrajectoryWriter interface. JuPedSim provides a writer that outputs trajectory data
                 in a sqlite database. If you want other formats such as CSV you need to provide
                 your own custom implementation.
+            num_threads: Number of threads used to compute the movement of
+                the agents. The results do not depend on the number of
+                threads. Custom models are always computed on one thread.
+            neighbor_list_skin: Enables Verlet neighbor lists with the given
+                skin in meters. Each agent keeps a list of the agents within
+                the cut off radius of the model plus the skin, which is
+                only rebuilt after an agent moved more than half the skin.
+                Larger skins rebuild less often but filter more candidates
+                per step. 0 disables the lists. Not supported by custom
+                models. See :meth:`neighbor_list_rebuild_count`.
+            wall_distance_field_resolution: Samples the distance to the
+                walls on a grid with this resolution in meters. The
+                collision free speed models then compute the boundary
+                repulsion from the closest wall in the field instead of
+                from every nearby wall. Choose a resolution well below the
+                agent radius. 0 disables the field.
+            grid_cell_size: Edge length in meters of the cells of the grids
+                used to find walls close to agents. Smaller cells return
+                fewer walls per query for dense geometries at the expense of
+                memory. 0 chooses the size from the density of the geometry.
+            geometry_cache_dir: Directory in which the triangulation and
+                navigation mesh of the geometry are cached. Simulations of
+                a geometry that is already in the cache skip building them,
+                which speeds up the start of large geometries. The directory
+                is created if it does not exist and may be shared by
+                simulations running in parallel. None disables the cache.
 
         Keyword Arguments:
             excluded_areas: describes exclusions
@@ -152,8 +184,24 @@ class Simulation:
             )
         self._writer = trajectory_writer
         self._obj = py_jps.Simulation(
-            model=py_jps_model, geometry=build_geometry(geometry)._obj, dt=dt
+            model=py_jps_model,
+            geometry=build_geometry(
+                geometry, grid_cell_size=grid_cell_size
+            )._obj,
+            dt=dt,
+            geometry_cache_dir=(
+                os.fspath(geometry_cache_dir)
+                if geometry_cache_dir is not None
+                else ""
+            ),
         )
+        self._obj.set_thread_count(num_threads)
+        if neighbor_list_skin != 0.0:
+            self._obj.set_neighbor_list_skin(neighbor_list_skin)
+        if wall_distance_field_resolution != 0.0:
+            self._obj.set_wall_distance_field_resolution(
+                wall_distance_field_resolution
+            )
         self._timer = Timer(self._obj, timer_log_level=timer_log_level)
 
     def add_waypoint_stage(
@@ -404,6 +452,47 @@ class Simulation:
         """
         return self._obj.iteration_count()
 
+    def num_threads(self) -> int:
+        """Number of threads used to compute the movement of the agents.
+
+        Returns:
+            Number of threads used in the operational step.
+        """
+        return self._obj.thread_count()
+
+    def neighbor_list_skin(self) -> float:
+        """Skin of the Verlet neighbor lists in meters.
+
+        Returns:
+            Skin of the neighbor lists, 0 if they are disabled.
+        """
+        return self._obj.neighbor_list_skin()
+
+    def neighbor_list_rebuild_count(self) -> int:
+        """Number of times the neighbor lists were rebuilt.
+
+        Returns:
+            Number of rebuilds since the simulation was created.
+        """
+        return self._obj.neighbor_list_rebuild_count()
+
+    def route_replan_count(self) -> int:
+        """Number of agents whose path was recomputed in the last iteration.
+
+        Agents keep their path between iterations and only recompute it
+        when their destination changes or they leave the corridor the path
+        runs through.
+        """
+        return self._obj.route_replan_count()
+
+    def wall_distance_field_resolution(self) -> float:
+        """Resolution of the wall distance field in meters.
+
+        Returns:
+            Resolution of the wall distance field, 0 if it is disabled.
+        """
+        return self._obj.wall_distance_field_resolution()
+
     def agents(self) -> Iterator[Agent]:
         """Agents in the simulation.
 
@@ -7,6 +7,7 @@ from typing import Final
 
 from shapely import from_wkt
 
+from jupedsim.geometry import Geometry
 from jupedsim.serialization import TrajectoryWriter
 from jupedsim.simulation import Simulation
 
@@ -65,6 +66,9 @@ class SqliteTrajectoryWriter(TrajectoryWriter):
             )
         self._commit_every_nth_write = commit_every_nth_write
         self._buffered_frame_count = 0
+        # Native hash and geometry table key of the last written geometry
+        self._geometry_hash: int | None = None
+        self._geometry_wkt_hash: int | None = None
 
     def begin_writing(self, simulation: Simulation) -> None:
         """Begin writing trajectory data.
@@ -119,6 +123,8 @@ class SqliteTrajectoryWriter(TrajectoryWriter):
             cur.execute("COMMIT")
         except sqlite3.Error as e:
             raise TrajectoryWriter.Exception(f"Error creating database: {e}")
+        self._geometry_hash = None
+        self._geometry_wkt_hash = None
 
     def write_iteration_state(self, simulation: Simulation) -> None:
         """Write trajectory data of one simulation iteration.
@@ -151,32 +157,13 @@ class SqliteTrajectoryWriter(TrajectoryWriter):
                 frame_data,
             )
 
-            geo_wkt = simulation.get_geometry().as_wkt()
-            geo_hash = hash(geo_wkt)
-            cur.execute(
-                "INSERT OR IGNORE INTO geometry(hash, wkt) VALUES(?,?)",
-                (geo_hash, geo_wkt),
-            )
+            # The WKT and bounds are only written when the geometry changed
+            geometry = simulation.get_geometry()
+            if geometry.hash() != self._geometry_hash:
+                self._write_geometry(cur, geometry)
             cur.execute(
                 "INSERT INTO frame_data VALUES(?, ?)",
-                (frame, geo_hash),
-            )
-
-            xmin, ymin, xmax, ymax = from_wkt(geo_wkt).bounds
-
-            old_xmin = self._x_min(cur)
-            old_xmax = self._x_max(cur)
-            old_ymin = self._y_min(cur)
-            old_ymax = self._y_max(cur)
-
-            cur.executemany(
-                "INSERT OR REPLACE INTO metadata(key, value) VALUES(?,?)",
-                [
-                    ("xmin", str(min(xmin, float(old_xmin)))),
-                    ("xmax", str(max(xmax, float(old_xmax)))),
-                    ("ymin", str(min(ymin, float(old_ymin)))),
-                    ("ymax", str(max(ymax, float(old_ymax)))),
-                ],
+                (frame, self._geometry_wkt_hash),
             )
             # Trigger flush if buffer full
             self._buffered_frame_count += 1
@@ -203,6 +190,33 @@ class SqliteTrajectoryWriter(TrajectoryWriter):
     def connection(self) -> sqlite3.Connection:
         return self._con
 
+    def _write_geometry(self, cur, geometry: Geometry) -> None:
+        geo_wkt = geometry.as_wkt()
+        geo_hash = hash(geo_wkt)
+        cur.execute(
+            "INSERT OR IGNORE INTO geometry(hash, wkt) VALUES(?,?)",
+            (geo_hash, geo_wkt),
+        )
+
+        xmin, ymin, xmax, ymax = from_wkt(geo_wkt).bounds
+
+        old_xmin = self._x_min(cur)
+        old_xmax = self._x_max(cur)
+        old_ymin = self._y_min(cur)
+        old_ymax = self._y_max(cur)
+
+        cur.executemany(
+            "INSERT OR REPLACE INTO metadata(key, value) VALUES(?,?)",
+            [
+                ("xmin", str(min(xmin, float(old_xmin)))),
+                ("xmax", str(max(xmax, float(old_xmax)))),
+                ("ymin", str(min(ymin, float(old_ymin)))),
+                ("ymax", str(max(ymax, float(old_ymax)))),
+            ],
+        )
+        self._geometry_hash = geometry.hash()
+        self._geometry_wkt_hash = geo_hash
+
     def _value_or_default(self, cur, key, default: float | int | str):
         res = cur.execute(
             "SELECT value FROM metadata WHERE key = ?", (key,)
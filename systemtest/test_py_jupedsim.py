@@ -440,6 +440,15 @@ def test_agent_can_be_removed_from_simulation():
     actual_agent_ids = {agent.id for agent in simulation.agents()}
     assert actual_agent_ids == expected_agent_ids
 
+    # remaining agents can still be looked up by id, removed agents not
+    for agent_id in expected_agent_ids:
+        assert simulation.agent(agent_id).id == agent_id
+    for agent_id in (agent_removed_id, second_agent_removed_id):
+        with pytest.raises(
+            jps.SimulationError, match=".*Trying to access unknown Agent.*"
+        ):
+            simulation.agent(agent_id)
+
 
 def test_agent_can_not_be_added_outside_geometry():
     messages = []
@@ -480,3 +489,269 @@ def test_agent_can_not_be_added_outside_geometry():
             stage_id=exit_id,
             state=jps.CollisionFreeSpeedModelState(position=(-50, -50)),
         )
+
+
+def evacuate_room(model, state_type, iterations=300, **simulation_kwargs):
+    """Runs a 40 m x 20 m room with agents on a 2 m grid towards an exit.
+
+    Returns:
+        The simulation after 'iterations' iterations.
+    """
+    simulation = jps.Simulation(
+        model=model(),
+        geometry=[(0, 0), (40, 0), (40, 20), (0, 20)],
+        **simulation_kwargs,
+    )
+    exit_id = simulation.add_exit_stage([(39, 8), (39, 12), (40, 12), (40, 8)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    for x in range(2, 20, 2):
+        for y in range(2, 19, 2):
+            simulation.add_agent(
+                journey_id=journey_id,
+                stage_id=exit_id,
+                state=state_type(position=(x, y)),
+            )
+    for _ in range(iterations):
+        simulation.iterate()
+    return simulation
+
+
+@pytest.mark.parametrize(
+    "model, state_type",
+    [
+        (jps.CollisionFreeSpeedModel, jps.CollisionFreeSpeedModelState),
+        (
+            jps.GeneralizedCentrifugalForceModel,
+            jps.GeneralizedCentrifugalForceModelState,
+        ),
+        (jps.SocialForceModel, jps.SocialForceModelState),
+        (jps.AnticipationVelocityModel, jps.AnticipationVelocityModelState),
+        (jps.WarpDriverModel, jps.WarpDriverModelState),
+    ],
+)
+def test_parallel_operational_step_matches_serial(model, state_type):
+    def run(num_threads):
+        simulation = evacuate_room(model, state_type, num_threads=num_threads)
+        assert simulation.num_threads() == num_threads
+        return [agent.position for agent in simulation.agents()]
+
+    assert run(1) == run(4)
+
+
+def test_parallel_operational_step_calls_python_log_callbacks():
+    warnings = []
+    jps.set_warning_callback(warnings.append)
+
+    simulation = jps.Simulation(
+        model=jps.GeneralizedCentrifugalForceModel(),
+        geometry=[(0, 0), (40, 0), (40, 20), (0, 20)],
+        num_threads=4,
+    )
+    exit_id = simulation.add_exit_stage([(39, 8), (39, 12), (40, 12), (40, 8)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    # Agents at the same position make the model log warnings on worker threads
+    for x in range(2, 20, 2):
+        for y in range(2, 19, 2):
+            for _ in range(2):
+                simulation.add_agent(
+                    journey_id=journey_id,
+                    stage_id=exit_id,
+                    state=jps.GeneralizedCentrifugalForceModelState(
+                        position=(x, y)
+                    ),
+                )
+    for _ in range(10):
+        simulation.iterate()
+
+    assert warnings
+
+
+def test_thread_count_must_be_positive():
+    with pytest.raises(jps.SimulationError):
+        jps.Simulation(
+            model=jps.CollisionFreeSpeedModel(),
+            geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+            num_threads=0,
+        )
+
+
+@pytest.mark.parametrize(
+    "model, state_type",
+    [
+        (jps.CollisionFreeSpeedModel, jps.CollisionFreeSpeedModelState),
+        (jps.SocialForceModel, jps.SocialForceModelState),
+        (jps.WarpDriverModel, jps.WarpDriverModelState),
+    ],
+)
+def test_neighbor_lists_match_grid_queries(model, state_type):
+    def positions(simulation):
+        return [c for agent in simulation.agents() for c in agent.position]
+
+    simulation = evacuate_room(model, state_type, iterations=0)
+    with_lists = evacuate_room(
+        model, state_type, iterations=0, neighbor_list_skin=0.3
+    )
+    assert with_lists.neighbor_list_skin() == 0.3
+
+    # Neighbors are visited in a different order, forces may differ in
+    # rounding. Comparing every step of a short run keeps these differences
+    # from growing.
+    for _ in range(50):
+        simulation.iterate()
+        with_lists.iterate()
+        assert positions(with_lists) == pytest.approx(
+            positions(simulation), abs=1e-9
+        )
+
+    assert simulation.neighbor_list_rebuild_count() == 0
+    assert 0 < with_lists.neighbor_list_rebuild_count() < 50
+
+
+def test_neighbor_lists_are_not_supported_by_custom_models():
+    class Model(jps.CustomOperationalModel):
+        def compute_next_state(self, dt, ped, geometry, neighborhood_search):
+            return ped.model
+
+    with pytest.raises(jps.SimulationError):
+        jps.Simulation(
+            model=Model(),
+            geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+            neighbor_list_skin=0.3,
+        )
+
+
+@pytest.mark.parametrize(
+    "model, state_type",
+    [
+        (jps.CollisionFreeSpeedModel, jps.CollisionFreeSpeedModelState),
+        (jps.CollisionFreeSpeedModelV2, jps.CollisionFreeSpeedModelV2State),
+    ],
+)
+def test_wall_distance_field_keeps_agents_in_corridor(model, state_type):
+    simulation = jps.Simulation(
+        model=model(),
+        geometry=[(0, 0), (30, 0), (30, 3), (0, 3)],
+        wall_distance_field_resolution=0.05,
+    )
+    assert simulation.wall_distance_field_resolution() == 0.05
+    exit_id = simulation.add_exit_stage([(29, 0), (30, 0), (30, 3), (29, 3)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    for x in range(1, 10):
+        for y in (0.5, 1.5, 2.5):
+            simulation.add_agent(
+                journey_id=journey_id,
+                stage_id=exit_id,
+                state=state_type(position=(x, y)),
+            )
+    while simulation.agent_count() > 0 and simulation.iteration_count() < 5000:
+        simulation.iterate()
+        for agent in simulation.agents():
+            assert 0 < agent.position[1] < 3
+    assert simulation.agent_count() == 0
+
+
+def test_wall_distance_field_resolution_must_not_be_negative():
+    with pytest.raises(jps.SimulationError):
+        jps.Simulation(
+            model=jps.CollisionFreeSpeedModel(),
+            geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+            wall_distance_field_resolution=-0.1,
+        )
+
+
+def test_grid_cell_size_can_be_chosen():
+    from jupedsim.geometry_utils import build_geometry
+
+    geometry = build_geometry(
+        [(0, 0), (10, 0), (10, 10), (0, 10)], grid_cell_size=2.5
+    )
+    assert geometry._obj.grid_cell_size() == 2.5
+
+
+def test_grid_cell_size_must_not_be_negative():
+    with pytest.raises(jps.SimulationError):
+        jps.Simulation(
+            model=jps.CollisionFreeSpeedModel(),
+            geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+            grid_cell_size=-1.0,
+        )
+
+
+def test_geometry_cache_is_filled_and_reused(tmp_path):
+    cache_dir = tmp_path / "cache"
+    geometry = shapely.Polygon(
+        [
+            (0, 0),
+            (10, 0),
+            (10, 4),
+            (20, 4),
+            (20, 6),
+            (10, 6),
+            (10, 10),
+            (0, 10),
+        ]
+    )
+
+    def run():
+        simulation = jps.Simulation(
+            model=jps.CollisionFreeSpeedModel(),
+            geometry=geometry,
+            geometry_cache_dir=cache_dir,
+        )
+        exit_id = simulation.add_exit_stage(
+            [(19, 4), (20, 4), (20, 6), (19, 6)]
+        )
+        journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+        simulation.add_agent(
+            journey_id=journey_id,
+            stage_id=exit_id,
+            state=jps.CollisionFreeSpeedModelState(position=(1, 1)),
+        )
+        positions = []
+        for _ in range(200):
+            simulation.iterate()
+            positions.extend(a.position for a in simulation.agents())
+        return positions
+
+    built = run()
+    assert len(list(cache_dir.iterdir())) == 1
+    assert run() == built
+    assert len(list(cache_dir.iterdir())) == 1
+
+
+def test_geometry_is_shared_and_identified_by_hash():
+    area = shapely.Polygon(
+        [(0, 0), (10, 0), (10, 10), (0, 10)],
+        holes=[[(2, 2), (2, 3), (3, 3), (3, 2)]],
+    )
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(), geometry=area
+    )
+    geometry = simulation.get_geometry()
+    assert geometry.hash() == simulation.get_geometry().hash()
+    assert geometry.as_wkt() == simulation.get_geometry().as_wkt()
+    assert shapely.from_wkt(geometry.as_wkt()).equals(area)
+
+    other = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (11, 0), (11, 10), (0, 10)],
+    )
+    assert other.get_geometry().hash() != geometry.hash()
+
+
+def test_agent_paths_are_kept_between_iterations():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 4), (0, 4)],
+    )
+    exit_id = simulation.add_exit_stage([(19, 1), (20, 1), (20, 3), (19, 3)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    simulation.add_agent(
+        journey_id=journey_id,
+        stage_id=exit_id,
+        state=jps.CollisionFreeSpeedModelState(position=(1, 2)),
+    )
+    # The path is computed when the agent is added and followed afterwards
+    for _ in range(100):
+        simulation.iterate()
+        assert simulation.route_replan_count() == 0
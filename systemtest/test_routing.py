@@ -141,3 +141,54 @@ def test_direct_path_possible_example(test_entry):
     assert distance == pytest.approx(
         direct_distance, abs=abs_tolerance, rel=rel_tolerance
     )
+
+
+@pytest.mark.parametrize(
+    "test_entry",
+    [
+        test_entry
+        for test_entry in BAD_ASTAR_ROUTINGS
+        if test_entry["error_type"] == "direct path possible"
+    ],
+    ids=lambda params: params["test_name"],
+)
+def test_polyanya_finds_direct_path(test_entry):
+    geometry = load_wkt_file(test_entry["wkt_path"])
+    navi = jps.RoutingEngine(
+        geometry, algorithm=jps.RoutingAlgorithm.POLYANYA
+    )
+
+    path = navi.compute_waypoints(*test_entry["path"])
+
+    assert path_distance(path) == pytest.approx(
+        path_distance(test_entry["path"]), abs=1e-9
+    )
+
+
+def test_polyanya_path_is_not_longer_than_triangle_a_star():
+    outer = [(0, 0), (100, 0), (100, 100), (0, 100)]
+    holes = [
+        [(40, 40), (60, 40), (60, 60), (40, 60)],
+        [(10, 70), (30, 70), (30, 75), (10, 75)],
+        [(70, 10), (75, 10), (75, 35), (70, 35)],
+    ]
+    a_star = jps.RoutingEngine(outer, excluded_areas=holes)
+    polyanya = jps.RoutingEngine(
+        outer,
+        algorithm=jps.RoutingAlgorithm.POLYANYA,
+        excluded_areas=holes,
+    )
+
+    for frm, to in [
+        ((50, 5), (50, 95)),
+        ((5, 50), (95, 50)),
+        ((20, 80), (20, 65)),
+        ((95, 20), (65, 20)),
+        ((1, 1), (99, 99)),
+    ]:
+        expected = a_star.compute_waypoints(frm, to)
+        path = polyanya.compute_waypoints(frm, to)
+        assert path[0] == frm
+        assert path[-1] == to
+        assert path_distance(path) <= path_distance(expected) + 1e-9
+        assert polyanya.last_search_expansions() > 0